@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include <cereal/cereal.hpp>
+#include <nodec_animation/animated_component_writer.hpp>
+#include <nodec_animation/resources/animation_clip.hpp>
+
+namespace {
+
+using namespace nodec_animation;
+using namespace nodec_animation::resources;
+
+struct Vector3 {
+    float x{0.f};
+    float y{0.f};
+    float z{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("x", x), cereal::make_nvp("y", y), cereal::make_nvp("z", z));
+    }
+};
+
+// Depth 1: properties directly on the component.
+struct FlatComponent {
+    float a{0.f};
+    float b{0.f};
+    float c{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("a", a), cereal::make_nvp("b", b), cereal::make_nvp("c", c));
+    }
+};
+
+// Depth 2: a transform-like component.
+struct TransformComponent {
+    Vector3 position;
+    Vector3 rotation;
+    Vector3 scale;
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("position", position),
+                cereal::make_nvp("rotation", rotation),
+                cereal::make_nvp("scale", scale));
+    }
+};
+
+// Depth 4: nested structures of which only the leaves are animated.
+struct DeepComponent {
+    struct Inner {
+        struct Leaf {
+            Vector3 value;
+
+            template<class Archive>
+            void serialize(Archive &archive) {
+                archive(cereal::make_nvp("value", value));
+            }
+        } leaf;
+        float unused{0.f};
+
+        template<class Archive>
+        void serialize(Archive &archive) {
+            archive(cereal::make_nvp("leaf", leaf), cereal::make_nvp("unused", unused));
+        }
+    } inner;
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("inner", inner));
+    }
+};
+
+AnimationCurve make_curve() {
+    AnimationCurve curve;
+    curve.add_keyframe({0.f, 0.f});
+    curve.add_keyframe({0.5f, 1.f});
+    curve.add_keyframe({1.f, 0.f});
+    curve.set_wrap_mode(WrapMode::Loop);
+    return curve;
+}
+
+template<class Component>
+void run_writer_benchmark(benchmark::State &state, const AnimationClip &clip, int property_count) {
+    const auto &animated_component = clip.root_entity().components.begin()->second;
+    const bool use_state = state.range(0) != 0;
+
+    Component component;
+    AnimatedComponentWriter writer;
+    AnimatedComponentWriter::ComponentAnimationState animation_state;
+    animation_state.bind(animated_component, animated_component.properties);
+
+    float time = 0.f;
+    for (auto _ : state) {
+        writer.write(animated_component, time, component, use_state ? &animation_state : nullptr);
+        benchmark::DoNotOptimize(component);
+        time += 1.f / 60.f;
+    }
+    state.SetItemsProcessed(state.iterations() * property_count);
+}
+
+void BM_WriteFlat(benchmark::State &state) {
+    AnimationClip clip;
+    for (const auto *name : {"a", "b", "c"}) {
+        clip.set_curve<FlatComponent>("", name, make_curve());
+    }
+    run_writer_benchmark<FlatComponent>(state, clip, 3);
+}
+
+void BM_WriteTransform(benchmark::State &state) {
+    AnimationClip clip;
+    for (const auto *vector : {"position", "rotation", "scale"}) {
+        for (const auto *axis : {"x", "y", "z"}) {
+            clip.set_curve<TransformComponent>("", std::string(vector) + "." + axis, make_curve());
+        }
+    }
+    run_writer_benchmark<TransformComponent>(state, clip, 9);
+}
+
+void BM_WriteDeep(benchmark::State &state) {
+    AnimationClip clip;
+    for (const auto *axis : {"x", "y", "z"}) {
+        clip.set_curve<DeepComponent>("", std::string("inner.leaf.value.") + axis, make_curve());
+    }
+    run_writer_benchmark<DeepComponent>(state, clip, 3);
+}
+
+// Argument: keep the hint state across writes (0/1).
+BENCHMARK(BM_WriteFlat)->ArgName("state")->Arg(0)->Arg(1);
+BENCHMARK(BM_WriteTransform)->ArgName("state")->Arg(0)->Arg(1);
+BENCHMARK(BM_WriteDeep)->ArgName("state")->Arg(0)->Arg(1);
+
+} // namespace
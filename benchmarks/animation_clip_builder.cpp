@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <nodec_animation/resources/animation_clip_builder.hpp>
+
+namespace {
+
+using namespace nodec_animation;
+using namespace nodec_animation::resources;
+
+struct Transform {
+    float value;
+};
+
+/**
+ * The paths of a skeleton-like tree, in the depth-first order importers write them in.
+ */
+std::vector<std::string> make_paths(int depth, int fanout) {
+    std::vector<std::string> paths{""};
+    std::vector<std::string> parents{""};
+    for (int level = 0; level < depth; ++level) {
+        std::vector<std::string> children;
+        for (const auto &parent : parents) {
+            for (int i = 0; i < fanout; ++i) {
+                children.push_back((parent.empty() ? "" : parent + "/") + "bone" + std::to_string(i));
+            }
+        }
+        paths.insert(paths.end(), children.begin(), children.end());
+        parents = std::move(children);
+    }
+    return paths;
+}
+
+AnimationCurve make_curve() {
+    AnimationCurve curve;
+    for (int i = 0; i < 8; ++i) curve.add_keyframe({static_cast<float>(i), static_cast<float>(i % 3)});
+    return curve;
+}
+
+const char *const property_names[] = {"position.x", "position.y", "position.z", "rotation.x", "rotation.y", "rotation.z"};
+
+/**
+ * Arguments: tree depth, use builder (0/1). The fanout is 4, and every entity has six curves.
+ */
+void BM_BuildClip(benchmark::State &state) {
+    const auto paths = make_paths(static_cast<int>(state.range(0)), 4);
+    const bool use_builder = state.range(1) != 0;
+    const auto curve = make_curve();
+
+    for (auto _ : state) {
+        // The curves are made outside of the measurement, as an importer hands them over.
+        state.PauseTiming();
+        std::vector<AnimationCurve> curves(paths.size() * 6, curve);
+        state.ResumeTiming();
+
+        std::shared_ptr<AnimationClip> clip;
+        if (use_builder) {
+            AnimationClipBuilder builder;
+            auto iter = curves.begin();
+            for (const auto &path : paths) {
+                for (const auto *name : property_names) builder.add_curve<Transform>(path, name, std::move(*iter++));
+            }
+            clip = builder.build();
+        } else {
+            clip = std::make_shared<AnimationClip>();
+            auto iter = curves.begin();
+            for (const auto &path : paths) {
+                for (const auto *name : property_names) clip->set_curve<Transform>(path, name, *iter++);
+            }
+        }
+        benchmark::DoNotOptimize(clip);
+    }
+    state.SetItemsProcessed(state.iterations() * paths.size() * 6);
+}
+
+BENCHMARK(BM_BuildClip)
+    ->ArgNames({"depth", "builder"})
+    ->ArgsProduct({{3, 5, 7}, {0, 1}});
+
+} // namespace
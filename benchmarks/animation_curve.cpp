@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <nodec_animation/animation_curve.hpp>
+
+namespace {
+
+using namespace nodec_animation;
+
+enum class Access {
+    Sequential,
+    Random,
+};
+
+AnimationCurve make_curve(int key_count, WrapMode wrap_mode) {
+    std::vector<Keyframe> keyframes;
+    keyframes.reserve(key_count);
+    for (int i = 0; i < key_count; ++i) {
+        keyframes.push_back({static_cast<float>(i), static_cast<float>(i % 7)});
+    }
+    AnimationCurve curve;
+    curve.set_keyframes(std::move(keyframes));
+    curve.set_wrap_mode(wrap_mode);
+    return curve;
+}
+
+/**
+ * Arguments: key count, wrap mode (0: Once, 1: Loop), use hint (0/1), access (0: sequential, 1: random).
+ */
+void BM_AnimationCurveEvaluate(benchmark::State &state) {
+    const auto key_count = static_cast<int>(state.range(0));
+    const auto wrap_mode = state.range(1) == 0 ? WrapMode::Once : WrapMode::Loop;
+    const bool use_hint = state.range(2) != 0;
+    const auto access = state.range(3) == 0 ? Access::Sequential : Access::Random;
+
+    const auto curve = make_curve(key_count, wrap_mode);
+    const float duration = curve.keyframes().back().time;
+
+    // Sample times are prepared in advance so that only evaluate() is measured.
+    // Sequential access advances about a quarter of a key per sample, like frames of a playback.
+    constexpr int sample_count = 4096;
+    std::vector<float> times(sample_count);
+    if (access == Access::Sequential) {
+        const float step = duration / (key_count * 4.f);
+        for (int i = 0; i < sample_count; ++i) {
+            times[i] = step * i;
+        }
+    } else {
+        std::mt19937 engine(12345);
+        std::uniform_real_distribution<float> distribution(0.f, duration);
+        for (auto &time : times) time = distribution(engine);
+    }
+
+    int hint = -1;
+    int index = 0;
+    for (auto _ : state) {
+        auto sample = curve.evaluate(times[index], use_hint ? hint : -1);
+        hint = sample.first;
+        benchmark::DoNotOptimize(sample);
+        index = (index + 1) & (sample_count - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_AnimationCurveEvaluate)
+    ->ArgNames({"keys", "loop", "hint", "random"})
+    ->ArgsProduct({{2, 4, 16, 256, 10000}, {0, 1}, {0, 1}, {0, 1}});
+
+} // namespace
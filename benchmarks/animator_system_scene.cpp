@@ -0,0 +1,388 @@
+// Scene-scale harness for AnimatorSystem.
+//
+// Builds a scene of animated hierarchies, binds clips through AnimatorStart and measures
+// the frame times of AnimatorSystem::update, the bind time and the memory in use.
+// The result is printed as a JSON object to stdout.
+//
+// Usage:
+//   nodec_animation__bench_animator_system_scene [--scenario=crowd|unique|churn]
+//       [--hierarchies=N] [--depth=N] [--fanout=N] [--components=N] [--properties=N]
+//       [--keys=N] [--frames=N] [--warmup=N] [--churn=RATIO] [--clips=N] [--order=storage|clip_hierarchy]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <cereal/cereal.hpp>
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_scene/scene.hpp>
+
+// --- Memory accounting ---
+
+namespace {
+
+struct AllocationCounters {
+    std::size_t current_bytes{0};
+    std::size_t peak_bytes{0};
+    std::size_t allocations{0};
+};
+
+AllocationCounters allocation_counters;
+
+// Each allocation is prefixed with its size so that the live bytes can be tracked.
+constexpr std::size_t allocation_header = alignof(std::max_align_t);
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    auto *block = static_cast<unsigned char *>(std::malloc(size + allocation_header));
+    if (!block) throw std::bad_alloc();
+    *reinterpret_cast<std::size_t *>(block) = size;
+
+    allocation_counters.current_bytes += size;
+    allocation_counters.peak_bytes = (std::max)(allocation_counters.peak_bytes, allocation_counters.current_bytes);
+    ++allocation_counters.allocations;
+    return block + allocation_header;
+}
+
+void operator delete(void *pointer) noexcept {
+    if (!pointer) return;
+    auto *block = static_cast<unsigned char *>(pointer) - allocation_header;
+    allocation_counters.current_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+namespace {
+
+using namespace nodec_scene;
+using namespace nodec_animation;
+using namespace nodec_animation::components;
+using namespace nodec_animation::systems;
+
+constexpr int max_properties = 8;
+
+template<int N>
+struct AnimatedComponent {
+    float values[max_properties]{};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        static const char *const names[max_properties] = {"p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7"};
+        for (int i = 0; i < max_properties; ++i) {
+            archive(cereal::make_nvp(names[i], values[i]));
+        }
+    }
+};
+
+using Component0 = AnimatedComponent<0>;
+using Component1 = AnimatedComponent<1>;
+using Component2 = AnimatedComponent<2>;
+using Component3 = AnimatedComponent<3>;
+constexpr int max_components = 4;
+
+struct Options {
+    std::string scenario{"crowd"};
+    int hierarchies{1000};
+    int depth{3};
+    int fanout{2};
+    int components{1};
+    int properties{3};
+    int keys{16};
+    int frames{300};
+    int warmup{30};
+    double churn{0.05};
+    int clips{2};
+    std::string order{"clip_hierarchy"};
+    bool arena{false};
+};
+
+bool parse_option(const char *arg, const char *name, std::string &value) {
+    const auto length = std::strlen(name);
+    if (std::strncmp(arg, name, length) != 0 || arg[length] != '=') return false;
+    value = arg + length + 1;
+    return true;
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parse_option(argv[i], "--scenario", value)) options.scenario = value;
+        else if (parse_option(argv[i], "--hierarchies", value)) options.hierarchies = std::stoi(value);
+        else if (parse_option(argv[i], "--depth", value)) options.depth = std::stoi(value);
+        else if (parse_option(argv[i], "--fanout", value)) options.fanout = std::stoi(value);
+        else if (parse_option(argv[i], "--components", value)) options.components = std::stoi(value);
+        else if (parse_option(argv[i], "--properties", value)) options.properties = std::stoi(value);
+        else if (parse_option(argv[i], "--keys", value)) options.keys = std::stoi(value);
+        else if (parse_option(argv[i], "--frames", value)) options.frames = std::stoi(value);
+        else if (parse_option(argv[i], "--warmup", value)) options.warmup = std::stoi(value);
+        else if (parse_option(argv[i], "--churn", value)) options.churn = std::stod(value);
+        else if (parse_option(argv[i], "--clips", value)) options.clips = std::stoi(value);
+        else if (parse_option(argv[i], "--order", value)) options.order = value;
+        else if (parse_option(argv[i], "--arena", value)) options.arena = value == "1" || value == "true";
+        else std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+    }
+    options.components = (std::max)(1, (std::min)(options.components, max_components));
+    options.properties = (std::max)(1, (std::min)(options.properties, max_properties));
+    options.clips = (std::max)(2, options.clips);
+    return options;
+}
+
+template<class Component>
+void set_component_curves(resources::AnimationClip &clip, const std::string &path,
+                          const Options &options, std::mt19937 &engine) {
+    std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+    for (int property = 0; property < options.properties; ++property) {
+        std::vector<Keyframe> keyframes;
+        keyframes.reserve(options.keys);
+        for (int key = 0; key < options.keys; ++key) {
+            keyframes.push_back({static_cast<float>(key) / 30.f, distribution(engine)});
+        }
+        AnimationCurve curve;
+        curve.set_keyframes(std::move(keyframes));
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip.set_curve<Component>(path, "p" + std::to_string(property), curve);
+    }
+}
+
+void set_entity_curves(resources::AnimationClip &clip, const std::string &path,
+                       const Options &options, std::mt19937 &engine) {
+    if (options.components > 0) set_component_curves<Component0>(clip, path, options, engine);
+    if (options.components > 1) set_component_curves<Component1>(clip, path, options, engine);
+    if (options.components > 2) set_component_curves<Component2>(clip, path, options, engine);
+    if (options.components > 3) set_component_curves<Component3>(clip, path, options, engine);
+}
+
+void build_clip_each(resources::AnimationClip &clip, const std::string &path, int depth,
+                     const Options &options, std::mt19937 &engine) {
+    set_entity_curves(clip, path, options, engine);
+    if (depth + 1 >= options.depth) return;
+
+    for (int child = 0; child < options.fanout; ++child) {
+        const auto name = "c" + std::to_string(child);
+        build_clip_each(clip, path.empty() ? name : path + "/" + name, depth + 1, options, engine);
+    }
+}
+
+std::shared_ptr<resources::AnimationClip> build_clip(const Options &options, unsigned seed,
+                                                     const std::shared_ptr<MonotonicArena> &arena) {
+    std::mt19937 engine(seed);
+    auto clip = arena ? std::make_shared<resources::AnimationClip>(arena)
+                      : std::make_shared<resources::AnimationClip>();
+    build_clip_each(*clip, "", 0, options, engine);
+    return clip;
+}
+
+template<class Component>
+void emplace_if(SceneRegistry &registry, SceneEntity entity, bool condition) {
+    if (condition) registry.emplace_component<Component>(entity);
+}
+
+SceneEntity build_hierarchy_each(Scene &scene, const std::string &name, int depth, const Options &options) {
+    auto entity = scene.create_entity(name);
+    auto &registry = scene.registry();
+    emplace_if<Component0>(registry, entity, options.components > 0);
+    emplace_if<Component1>(registry, entity, options.components > 1);
+    emplace_if<Component2>(registry, entity, options.components > 2);
+    emplace_if<Component3>(registry, entity, options.components > 3);
+
+    if (depth + 1 >= options.depth) return entity;
+
+    for (int child = 0; child < options.fanout; ++child) {
+        auto child_entity = build_hierarchy_each(scene, "c" + std::to_string(child), depth + 1, options);
+        scene.hierarchy_system().append_child(entity, child_entity);
+    }
+    return entity;
+}
+
+struct FrameStatistics {
+    double mean{0.0};
+    double p50{0.0};
+    double p99{0.0};
+    double max{0.0};
+};
+
+FrameStatistics summarize(std::vector<double> samples) {
+    FrameStatistics statistics;
+    if (samples.empty()) return statistics;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (auto sample : samples) sum += sample;
+
+    auto percentile = [&](double ratio) {
+        const auto index = static_cast<std::size_t>(ratio * (samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+
+    statistics.mean = sum / samples.size();
+    statistics.p50 = percentile(0.5);
+    statistics.p99 = percentile(0.99);
+    statistics.max = samples.back();
+    return statistics;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const auto options = parse_options(argc, argv);
+
+    if (options.scenario != "crowd" && options.scenario != "unique" && options.scenario != "churn") {
+        std::fprintf(stderr, "Unknown scenario: %s\n", options.scenario.c_str());
+        return 1;
+    }
+    if (options.order != "storage" && options.order != "clip_hierarchy") {
+        std::fprintf(stderr, "Unknown order: %s\n", options.order.c_str());
+        return 1;
+    }
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<Component0>();
+    component_registry.register_component<Component1>();
+    component_registry.register_component<Component2>();
+    component_registry.register_component<Component3>();
+
+    AnimatorSystem animator_system(component_registry);
+    animator_system.set_evaluation_order(options.order == "storage" ? EvaluationOrder::storage
+                                                                    : EvaluationOrder::clip_hierarchy);
+
+    const auto memory_at_start = allocation_counters.current_bytes;
+
+    // --- Clips ---
+    std::vector<std::shared_ptr<resources::AnimationClip>> clips;
+    // With --arena=1 all clips are built into one arena, packing their curves and trees into few blocks.
+    std::shared_ptr<MonotonicArena> arena;
+    if (options.arena) arena = std::make_shared<MonotonicArena>(1 << 20);
+    {
+        const int clip_count = options.scenario == "unique" ? options.hierarchies : options.clips;
+        clips.reserve(clip_count);
+        for (int i = 0; i < clip_count; ++i) {
+            clips.push_back(build_clip(options, static_cast<unsigned>(i + 1), arena));
+        }
+    }
+    const auto memory_clips = allocation_counters.current_bytes - memory_at_start;
+
+    // --- Scene ---
+    Scene scene;
+    auto &registry = scene.registry();
+
+    std::vector<SceneEntity> roots;
+    roots.reserve(options.hierarchies);
+    for (int i = 0; i < options.hierarchies; ++i) {
+        roots.push_back(build_hierarchy_each(scene, "root", 0, options));
+    }
+    const auto memory_scene = allocation_counters.current_bytes - memory_at_start - memory_clips;
+
+    // --- Bind ---
+    for (int i = 0; i < options.hierarchies; ++i) {
+        const auto &clip = options.scenario == "unique" ? clips[i] : clips[0];
+        registry.emplace_component<Animator>(roots[i]).first.clip = clip;
+        registry.emplace_component<AnimatorStart>(roots[i]);
+    }
+
+    const auto memory_before_bind = allocation_counters.current_bytes;
+    const auto bind_begin = std::chrono::steady_clock::now();
+    animator_system.update(registry, 0.f);
+    const auto bind_ms = elapsed_ms(bind_begin);
+    const auto memory_bind = allocation_counters.current_bytes - memory_before_bind;
+
+    // --- Frames ---
+    std::mt19937 engine(7);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<SceneEntity> stopped;
+
+    std::vector<double> frame_times;
+    frame_times.reserve(options.frames);
+
+    const auto allocations_before_frames = allocation_counters.allocations;
+    constexpr float delta_time = 1.f / 60.f;
+
+    for (int frame = 0; frame < options.warmup + options.frames; ++frame) {
+        if (options.scenario == "churn") {
+            // Restart the animators stopped in the previous frame with a random clip,
+            // and stop another random subset.
+            for (auto entity : stopped) {
+                auto &animator = registry.get_component<Animator>(entity);
+                animator.clip = clips[static_cast<std::size_t>(distribution(engine) * clips.size()) % clips.size()];
+                registry.emplace_component<AnimatorStart>(entity);
+            }
+            stopped.clear();
+            for (auto entity : roots) {
+                if (distribution(engine) < options.churn) {
+                    registry.emplace_component<AnimatorStop>(entity);
+                    stopped.push_back(entity);
+                }
+            }
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        animator_system.update(registry, delta_time);
+        const auto ms = elapsed_ms(begin);
+
+        if (frame >= options.warmup) frame_times.push_back(ms);
+    }
+
+    const auto frame_allocations = allocation_counters.allocations - allocations_before_frames;
+    const auto statistics = summarize(frame_times);
+
+    const int entities_per_hierarchy = [&]() {
+        int count = 0;
+        int level = 1;
+        for (int depth = 0; depth < options.depth; ++depth) {
+            count += level;
+            level *= options.fanout;
+        }
+        return count;
+    }();
+
+    std::printf("{\n");
+    std::printf("  \"scenario\": \"%s\",\n", options.scenario.c_str());
+    std::printf("  \"hierarchies\": %d,\n", options.hierarchies);
+    std::printf("  \"depth\": %d,\n", options.depth);
+    std::printf("  \"fanout\": %d,\n", options.fanout);
+    std::printf("  \"components\": %d,\n", options.components);
+    std::printf("  \"properties\": %d,\n", options.properties);
+    std::printf("  \"keys\": %d,\n", options.keys);
+    std::printf("  \"entities\": %d,\n", options.hierarchies * entities_per_hierarchy);
+    std::printf("  \"clips\": %d,\n", static_cast<int>(clips.size()));
+    std::printf("  \"order\": \"%s\",\n", options.order.c_str());
+    std::printf("  \"arena_blocks\": %zu,\n", arena ? arena->block_count() : static_cast<std::size_t>(0));
+    std::printf("  \"frames\": %d,\n", options.frames);
+    std::printf("  \"bind_ms\": %.6f,\n", bind_ms);
+    std::printf("  \"frame_ms\": {\"mean\": %.6f, \"p50\": %.6f, \"p99\": %.6f, \"max\": %.6f},\n",
+                statistics.mean, statistics.p50, statistics.p99, statistics.max);
+    std::printf("  \"allocations_per_frame\": %.3f,\n",
+                static_cast<double>(frame_allocations) / (options.warmup + options.frames));
+    std::printf("  \"memory_bytes\": {\"clips\": %zu, \"scene\": %zu, \"bind\": %zu, \"peak\": %zu}\n",
+                memory_clips, memory_scene, memory_bind, allocation_counters.peak_bytes);
+    std::printf("}\n");
+
+    return 0;
+}
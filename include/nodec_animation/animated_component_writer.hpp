@@ -1,9 +1,13 @@
 #ifndef NODEC_ANIMATION__ANIMATED_COMPONENT_WRITER_HPP_
 #define NODEC_ANIMATION__ANIMATED_COMPONENT_WRITER_HPP_
 
+#include <cstring>
+
 #include <cereal/cereal.hpp>
 
+#include <nodec_animation/playback_time.hpp>
 #include <nodec_animation/resources/animation_clip.hpp>
+#include <nodec_animation/statistics.hpp>
 
 namespace nodec_animation {
 
@@ -16,20 +20,66 @@ class AnimatedComponentWriter {
 
 public:
     struct PropertyAnimationState {
-        int current_index;
+        int current_index{-1};
+
+        /**
+         * @brief The property written with this state.
+         */
+        const nodec_animation::resources::AnimatedProperty *property{nullptr};
     };
 
     struct ComponentAnimationState {
+        /**
+         * @brief The component the properties below belong to.
+         */
+        const nodec_animation::resources::AnimatedComponent *source{nullptr};
         std::unordered_map<std::string, PropertyAnimationState> properties;
+
+        /**
+         * @brief Creates the states of the properties to write up front, referring to the properties of the source,
+         * so that writing them never inserts into the map.
+         *
+         * The properties are entries of the property map of the source, or pointers to them. The states of other
+         * properties are dropped. If keep_hints is true, the hints of the remaining ones are kept; they are only
+         * a starting point of the search.
+         */
+        template<class Properties>
+        void bind(const nodec_animation::resources::AnimatedComponent &source, const Properties &source_properties,
+                  bool keep_hints = false) {
+            this->source = &source;
+            for (auto &property : properties) property.second.property = nullptr;
+
+            for (const auto &source_property : source_properties) {
+                const auto &entry = entry_of(source_property);
+                auto &state = properties[entry.first];
+                if (!keep_hints) state.current_index = -1;
+                state.property = &entry.second;
+            }
+
+            for (auto iter = properties.begin(); iter != properties.end();) {
+                iter = iter->second.property ? std::next(iter) : properties.erase(iter);
+            }
+        }
+
+    private:
+        using PropertyEntry = nodec_animation::resources::AnimatedComponent::PropertyMap::value_type;
+
+        static const PropertyEntry &entry_of(const PropertyEntry &entry) noexcept {
+            return entry;
+        }
+
+        static const PropertyEntry &entry_of(const PropertyEntry *entry) noexcept {
+            return *entry;
+        }
     };
 
     class PropertyWriter : public cereal::InputArchive<PropertyWriter> {
     public:
         PropertyWriter(const nodec_animation::resources::AnimatedComponent &source,
-                       float time,
-                       AnimatedComponentWriter &owner, ComponentAnimationState *state, InternalTag)
+                       PlaybackTime time,
+                       AnimatedComponentWriter &owner, ComponentAnimationState *state, float weight, InternalTag)
             : InputArchive(this),
-              source_(source), time_(time), owner_(owner), state_(state) {}
+              source_(source), time_(time), owner_(owner), state_(state), weight_(weight) {}
 
         void load_value(std::string &) {
             // Ignore.
@@ -37,56 +87,74 @@ public:
 
         template<class T, cereal::traits::EnableIf<std::is_arithmetic<T>::value> = cereal::traits::sfinae>
         void load_value(T &value) {
-            auto iter = source_.properties.find(current_property_name_);
-            if (iter == source_.properties.end()) return;
-
-            auto *property_animation_state = [&]() -> PropertyAnimationState * {
-                if (!state_) return nullptr;
-                return &state_->properties[current_property_name_];
-            }();
-
-            const auto &property = iter->second;
-            const auto &curve = property.curve;
-            auto sample = curve.evaluate(time_,
-                                         property_animation_state
-                                             ? property_animation_state->current_index
-                                             : -1);
-
-            value = static_cast<T>(sample.second);
+            const auto &property_name = owner_.current_property_name_;
+
+            const nodec_animation::resources::AnimatedProperty *property;
+            PropertyAnimationState *property_animation_state = nullptr;
+            if (state_ && state_->source) {
+                // The state has been bound to the properties to write.
+                auto iter = state_->properties.find(property_name);
+                if (iter == state_->properties.end()) return;
+                property_animation_state = &iter->second;
+                property = iter->second.property;
+            } else {
+                auto iter = source_.properties.find(property_name);
+                if (iter == source_.properties.end()) return;
+                property = &iter->second;
+
+                // A state which has not been bound gets the hints of all properties written, created on first use.
+                if (state_) property_animation_state = &state_->properties[property_name];
+            }
+
+            const auto &curve = property->curve;
+            const int hint = property_animation_state ? property_animation_state->current_index : -1;
+            auto sample = time_.in_ticks()
+                              ? curve.evaluate_ticks(time_.ticks, time_.ticks_per_second, hint)
+                              : curve.evaluate(time_.seconds, hint);
+
+            value = weight_ < 1.f
+                        ? static_cast<T>(value + (sample.second - value) * weight_)
+                        : static_cast<T>(sample.second);
             if (property_animation_state) {
                 property_animation_state->current_index = sample.first;
             }
+            NODEC_ANIMATION_STATISTICS(++impl::evaluation_counters().property_writes);
         }
 
         void start_node(const char *name) {
-            name_stack_.emplace_back(name);
+            auto &name_stack = owner_.name_stack_;
+            auto &property_name = owner_.current_property_name_;
+
+            name_stack.emplace_back(name);
             if (name == nullptr) return;
 
-            if (current_property_name_.size() > 0) {
-                current_property_name_ += ".";
+            if (property_name.size() > 0) {
+                property_name += ".";
             }
-            current_property_name_ += name;
+            property_name += name;
         }
 
         void end_node() {
-            auto last = name_stack_.back();
-            name_stack_.pop_back();
+            auto &name_stack = owner_.name_stack_;
+            auto &property_name = owner_.current_property_name_;
+
+            auto last = name_stack.back();
+            name_stack.pop_back();
 
             if (last == nullptr) return;
 
-            current_property_name_.erase(current_property_name_.size() - std::strlen(last));
-            if (current_property_name_.size() > 0) {
-                current_property_name_.erase(current_property_name_.size() - 1);
+            property_name.erase(property_name.size() - std::strlen(last));
+            if (property_name.size() > 0) {
+                property_name.erase(property_name.size() - 1);
             }
         }
 
     private:
         const nodec_animation::resources::AnimatedComponent &source_;
-        const float time_;
+        const PlaybackTime time_;
         AnimatedComponentWriter &owner_;
-        std::vector<const char *> name_stack_;
-        std::string current_property_name_;
         ComponentAnimationState *state_;
+        const float weight_;
     };
 
     AnimatedComponentWriter() {
@@ -95,17 +163,31 @@ public:
     /**
      * @brief Writes properties of source on the specific time to the dest.
      *
+     * The buffers used to build property names are kept by the writer,
+     * so reusing one writer makes repeated writes free of allocations.
+     *
      * @param source
      * @param dest
+     * @param state The hints of the properties. If it has been bound, see ComponentAnimationState::bind(),
+     * only the properties it has been bound to are written. Otherwise all of the source are, and their hints
+     * are created on the first write.
+     * @param weight Blend factor between the current value of dest (0) and the sampled value (1).
      */
     template<typename Component>
     void write(const nodec_animation::resources::AnimatedComponent &source,
-               float time,
-               Component &dest, ComponentAnimationState *state = nullptr) {
-        PropertyWriter writer(source, time, *this, state, InternalTag{});
+               PlaybackTime time,
+               Component &dest, ComponentAnimationState *state = nullptr, float weight = 1.f) {
+        name_stack_.clear();
+        current_property_name_.clear();
+
+        PropertyWriter writer(source, time, *this, state, weight, InternalTag{});
 
         writer(dest);
     }
+
+private:
+    std::vector<const char *> name_stack_;
+    std::string current_property_name_;
 };
 
 // --- PropertyWriter ---
@@ -1,7 +1,10 @@
 #ifndef NODEC_ANIMATION__ANIMATION_CURVE_HPP_
 #define NODEC_ANIMATION__ANIMATION_CURVE_HPP_
 
+#include "arena.hpp"
 #include "keyframe.hpp"
+#include "playback_time.hpp"
+#include "statistics.hpp"
 #include "wrap_mode.hpp"
 
 #include <nodec/algorithm.hpp>
@@ -10,44 +13,175 @@
 #include <cassert>
 #include <cmath>
 #include <iterator>
+#include <memory>
 #include <vector>
 
 namespace nodec_animation {
 
+/**
+ * @brief The number of keyframes an AnimationCurve stores inline, without a heap allocation.
+ */
+#ifndef NODEC_ANIMATION_CURVE_INLINE_CAPACITY
+#    define NODEC_ANIMATION_CURVE_INLINE_CAPACITY 4
+#endif
+
 class AnimationCurve {
 public:
-    using iterator = std::vector<Keyframe>::const_iterator;
+    using allocator_type = ArenaAllocator<Keyframe>;
+    using KeyframeVector = std::vector<Keyframe, allocator_type>;
+    using iterator = KeyframeSpan::const_iterator;
+
+    /**
+     * @brief Curves with up to this many keyframes keep them inside the curve.
+     * Longer curves spill them into a vector using the allocator of the curve.
+     */
+    static constexpr std::size_t inline_capacity = NODEC_ANIMATION_CURVE_INLINE_CAPACITY;
+    static_assert(inline_capacity > 0, "At least one keyframe must be stored inline.");
 
     AnimationCurve() {}
 
+    explicit AnimationCurve(const allocator_type &allocator)
+        : keyframes_(allocator) {}
+
     AnimationCurve(const AnimationCurve &other)
         : keyframes_(other.keyframes_),
-          wrap_mode_(other.wrap_mode_) {
+          shared_keyframes_(other.shared_keyframes_),
+          referenced_keyframes_(other.referenced_keyframes_),
+          referenced_size_(other.referenced_size_),
+          wrap_mode_(other.wrap_mode_),
+          ticks_per_second_(other.ticks_per_second_),
+          end_ticks_(other.end_ticks_) {
+        copy_inline(other);
+    }
+
+    AnimationCurve(const AnimationCurve &other, const allocator_type &allocator)
+        : keyframes_(other.keyframes_, allocator),
+          shared_keyframes_(other.shared_keyframes_),
+          referenced_keyframes_(other.referenced_keyframes_),
+          referenced_size_(other.referenced_size_),
+          wrap_mode_(other.wrap_mode_),
+          ticks_per_second_(other.ticks_per_second_),
+          end_ticks_(other.end_ticks_) {
+        copy_inline(other);
+    }
+
+    AnimationCurve(AnimationCurve &&other, const allocator_type &allocator)
+        : keyframes_(std::move(other.keyframes_), allocator),
+          shared_keyframes_(std::move(other.shared_keyframes_)),
+          referenced_keyframes_(std::move(other.referenced_keyframes_)),
+          referenced_size_(other.referenced_size_),
+          wrap_mode_(other.wrap_mode_),
+          ticks_per_second_(other.ticks_per_second_),
+          end_ticks_(other.end_ticks_) {
+        copy_inline(other);
     }
 
     AnimationCurve &operator=(const AnimationCurve &other) {
         keyframes_ = other.keyframes_;
+        shared_keyframes_ = other.shared_keyframes_;
+        referenced_keyframes_ = other.referenced_keyframes_;
+        referenced_size_ = other.referenced_size_;
         wrap_mode_ = other.wrap_mode_;
+        ticks_per_second_ = other.ticks_per_second_;
+        end_ticks_ = other.end_ticks_;
+        copy_inline(other);
         return *this;
     }
 
     AnimationCurve(AnimationCurve &&other) noexcept
         : keyframes_(std::move(other.keyframes_)),
-          wrap_mode_(other.wrap_mode_) {
+          shared_keyframes_(std::move(other.shared_keyframes_)),
+          referenced_keyframes_(std::move(other.referenced_keyframes_)),
+          referenced_size_(other.referenced_size_),
+          wrap_mode_(other.wrap_mode_),
+          ticks_per_second_(other.ticks_per_second_),
+          end_ticks_(other.end_ticks_) {
+        copy_inline(other);
     }
 
     AnimationCurve &operator=(AnimationCurve &&other) noexcept {
         keyframes_ = std::move(other.keyframes_);
+        shared_keyframes_ = std::move(other.shared_keyframes_);
+        referenced_keyframes_ = std::move(other.referenced_keyframes_);
+        referenced_size_ = other.referenced_size_;
         wrap_mode_ = other.wrap_mode_;
+        ticks_per_second_ = other.ticks_per_second_;
+        end_ticks_ = other.end_ticks_;
+        copy_inline(other);
         return *this;
     }
 
-    const std::vector<Keyframe> &keyframes() const {
-        return keyframes_;
+    KeyframeSpan keyframes() const noexcept {
+        if (shared_keyframes_) return {shared_keyframes_->data(), shared_keyframes_->size()};
+        if (referenced_keyframes_) return {referenced_keyframes_.get(), referenced_size_};
+        if (inline_size_ > 0) return {inline_keyframes_, inline_size_};
+        return {keyframes_.data(), keyframes_.size()};
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return keyframes_.get_allocator();
     }
 
     void set_keyframes(std::vector<Keyframe> &&keyframes) {
-        keyframes_ = std::move(keyframes);
+        // Copied, so that the keyframes stay in the memory of this curve.
+        set_keyframes(keyframes.data(), keyframes.data() + keyframes.size());
+    }
+
+    /**
+     * @brief Copies the keyframes of the range, which must be sorted by time.
+     */
+    void set_keyframes(const Keyframe *begin, const Keyframe *end) {
+        shared_keyframes_.reset();
+        release_referenced();
+        ticks_per_second_ = 0;
+
+        const auto size = static_cast<std::size_t>(end - begin);
+        if (size <= inline_capacity) {
+            std::copy(begin, end, inline_keyframes_);
+            inline_size_ = size;
+            keyframes_.clear();
+            return;
+        }
+        inline_size_ = 0;
+        keyframes_.assign(begin, end);
+    }
+
+    /**
+     * @brief Makes the curve use keyframes shared with other curves, e.g. by a resources::CurveStore.
+     *
+     * The shared keyframes are never changed. Adding or setting keyframes afterwards gives the curve its own copy again.
+     */
+    void share_keyframes(std::shared_ptr<const KeyframeVector> keyframes) {
+        shared_keyframes_ = std::move(keyframes);
+        release_referenced();
+        ticks_per_second_ = 0;
+        inline_size_ = 0;
+        keyframes_.clear();
+        keyframes_.shrink_to_fit();
+    }
+
+    const std::shared_ptr<const KeyframeVector> &shared_keyframes() const noexcept {
+        return shared_keyframes_;
+    }
+
+    /**
+     * @brief Makes the curve read keyframes in memory it does not own, e.g. those of a memory-mapped binary clip.
+     *
+     * The pointer keeps the memory alive, typically by the aliasing constructor of std::shared_ptr. Like shared
+     * keyframes, they are never changed: adding or setting keyframes afterwards gives the curve its own copy.
+     */
+    void reference_keyframes(std::shared_ptr<const Keyframe> keyframes, std::size_t size) {
+        shared_keyframes_.reset();
+        referenced_keyframes_ = std::move(keyframes);
+        referenced_size_ = referenced_keyframes_ ? size : 0;
+        ticks_per_second_ = 0;
+        inline_size_ = 0;
+        keyframes_.clear();
+        keyframes_.shrink_to_fit();
+    }
+
+    const std::shared_ptr<const Keyframe> &referenced_keyframes() const noexcept {
+        return referenced_keyframes_;
     }
 
     void set_wrap_mode(const WrapMode &mode) {
@@ -59,34 +193,129 @@ public:
     }
 
     int add_keyframe(const Keyframe &keyframe) {
+        detach();
+        ticks_per_second_ = 0;
+
+        if (keyframes_.empty() && inline_size_ < inline_capacity) {
+            auto *end = inline_keyframes_ + inline_size_;
+            auto *iter = std::lower_bound(inline_keyframes_, end, keyframe);
+            std::copy_backward(iter, end, end + 1);
+            *iter = keyframe;
+            ++inline_size_;
+            return static_cast<int>(iter - inline_keyframes_);
+        }
+
+        if (keyframes_.empty()) {
+            // Spilling out of the inline storage.
+            keyframes_.reserve(inline_capacity * 2);
+            keyframes_.assign(inline_keyframes_, inline_keyframes_ + inline_size_);
+            inline_size_ = 0;
+        }
+
         auto iter = std::lower_bound(keyframes_.begin(), keyframes_.end(), keyframe);
         iter = keyframes_.insert(iter, keyframe);
         return static_cast<int>(std::distance(keyframes_.begin(), iter));
     }
 
+    /**
+     * @brief Converts the end of the curve to ticks, so that evaluate_ticks() needs no conversion.
+     *
+     * The conversion is dropped when the keyframes change, after which evaluate_ticks() converts on every call.
+     */
+    void prepare_ticks(std::uint32_t ticks_per_second) noexcept {
+        const KeyframeSpan keyframes = this->keyframes();
+        if (ticks_per_second == 0 || keyframes.empty()) return;
+        end_ticks_ = seconds_to_ticks(keyframes.back().time, ticks_per_second);
+        ticks_per_second_ = ticks_per_second;
+    }
+
     /**
      * @brief
      *
-     * @param ticks
+     * @param time
      * @param hint
      * @return std::pair<int, float>
      */
     std::pair<int, float> evaluate(float time, int hint = -1) const {
-        if (keyframes_.size() == 0) return std::make_pair(-1, 0.0f);
+        const KeyframeSpan keyframes = this->keyframes();
+        if (keyframes.size() == 0) return std::make_pair(-1, 0.0f);
 
-        Keyframe current;
-        current.time = [&]() {
+        const float local_time = [&]() {
             switch (wrap_mode_) {
             case WrapMode::Once:
             default:
-                return nodec::clamp(time, 0.f, keyframes_.back().time);
+                return nodec::clamp(time, 0.f, keyframes.back().time);
 
-            case WrapMode::Loop:
-                return std::fmod(time, keyframes_.back().time);
+            case WrapMode::Loop: {
+                // A constant curve. Nothing to wrap.
+                if (keyframes.size() == 1) return 0.f;
+
+                // Negative times appear in reverse playback.
+                const auto end = keyframes.back().time;
+                const auto wrapped = std::fmod(time, end);
+                return wrapped < 0.f ? wrapped + end : wrapped;
+            }
+            }
+        }();
+
+        return evaluate_local(keyframes, local_time, hint);
+    }
+
+    /**
+     * @brief Evaluates the curve at a time in integer ticks.
+     *
+     * Looping curves are wrapped by integer arithmetic, so the result does not depend on how far the time has grown.
+     */
+    std::pair<int, float> evaluate_ticks(std::int64_t ticks, std::uint32_t ticks_per_second, int hint = -1) const {
+        const KeyframeSpan keyframes = this->keyframes();
+        if (keyframes.size() == 0) return std::make_pair(-1, 0.0f);
+
+        const auto end_ticks = ticks_per_second == ticks_per_second_
+                                   ? end_ticks_
+                                   : seconds_to_ticks(keyframes.back().time, ticks_per_second);
+
+        const auto local_ticks = [&]() -> std::int64_t {
+            switch (wrap_mode_) {
+            case WrapMode::Once:
+            default:
+                return nodec::clamp(ticks, std::int64_t(0), end_ticks);
+
+            case WrapMode::Loop: {
+                if (end_ticks <= 0) return 0;
+
+                const auto wrapped = ticks % end_ticks;
+                return wrapped < 0 ? wrapped + end_ticks : wrapped;
+            }
             }
         }();
 
-        assert(0 <= current.time && current.time <= keyframes_.back().time);
+        // Within one loop the seconds are exact enough. Rounding may put the end in ticks past the last keyframe.
+        const auto local_time = (std::min)(static_cast<float>(ticks_to_seconds(local_ticks, ticks_per_second)),
+                                           keyframes.back().time);
+        return evaluate_local(keyframes, local_time, hint);
+    }
+
+private:
+    std::pair<int, float> evaluate_local(const KeyframeSpan &keyframes, float local_time, int hint) const {
+        NODEC_ANIMATION_STATISTICS(auto &counters = impl::evaluation_counters());
+        NODEC_ANIMATION_STATISTICS(++counters.curves_evaluated);
+
+        // A constant curve. Nothing to search.
+        if (keyframes.size() == 1) return {0, keyframes[0].value};
+
+        Keyframe current;
+        current.time = local_time;
+
+        assert(0 <= current.time && current.time <= keyframes.back().time);
+
+        if (keyframes.size() == 2) {
+            // A single segment. The same results as the search below, without searching.
+            const auto &first = keyframes[0];
+            const auto &last = keyframes[1];
+            if (current.time < first.time) return {0, first.value};
+            if (last.time <= current.time) return {1, last.value};
+            return {0, first.value + (last.value - first.value) / (last.time - first.time) * (current.time - first.time)};
+        }
 
         auto iter = [&]() {
             // The hint index should be in the range [0, last - 1]
@@ -94,44 +323,51 @@ public:
             // |<--   hint   -->|
             // o   o    o       o   o
             //                      ^last
-            if (hint < 0 || keyframes_.size() - 1 <= hint) {
-                return std::upper_bound(keyframes_.begin(), keyframes_.end(), current);
+            if (hint < 0 || keyframes.size() - 1 <= hint) {
+                NODEC_ANIMATION_STATISTICS(++counters.upper_bound_fallbacks);
+                return std::upper_bound(keyframes.begin(), keyframes.end(), current);
             }
 
-            assert(0 <= hint && hint < keyframes_.size() - 1);
+            assert(0 <= hint && hint < keyframes.size() - 1);
 
-            if (current.time < keyframes_[hint].time) {
-                if (keyframes_[hint - 1].time <= current.time) {
-                    return keyframes_.begin() + hint;
+            if (current.time < keyframes[hint].time) {
+                if (hint == 0 || keyframes[hint - 1].time <= current.time) {
+                    NODEC_ANIMATION_STATISTICS(++counters.hint_hits);
+                    return keyframes.begin() + hint;
                 }
 
-                return std::upper_bound(keyframes_.begin(), keyframes_.begin() + hint - 1, current);
+                NODEC_ANIMATION_STATISTICS(++counters.upper_bound_fallbacks);
+                return std::upper_bound(keyframes.begin(), keyframes.begin() + hint - 1, current);
             }
 
-            if (current.time < keyframes_[hint + 1].time) {
-                return keyframes_.begin() + hint + 1;
+            if (current.time < keyframes[hint + 1].time) {
+                NODEC_ANIMATION_STATISTICS(++counters.hint_hits);
+                return keyframes.begin() + hint + 1;
             }
 
-            if (keyframes_.size() <= hint + 2) {
-                return keyframes_.end();
+            if (keyframes.size() <= hint + 2) {
+                NODEC_ANIMATION_STATISTICS(++counters.hint_hits);
+                return keyframes.end();
             }
 
-            if (current.time < keyframes_[hint + 2].time) {
-                return keyframes_.begin() + hint + 2;
+            if (current.time < keyframes[hint + 2].time) {
+                NODEC_ANIMATION_STATISTICS(++counters.hint_hits);
+                return keyframes.begin() + hint + 2;
             }
 
-            return std::upper_bound(keyframes_.begin() + hint + 2, keyframes_.end(), current);
+            NODEC_ANIMATION_STATISTICS(++counters.upper_bound_fallbacks);
+            return std::upper_bound(keyframes.begin() + hint + 2, keyframes.end(), current);
         }();
 
-        assert(keyframes_.size() > 0);
+        assert(keyframes.size() > 0);
 
         // o  x         o
         //    ^current  ^iter
-        const int index = static_cast<int>(std::distance(keyframes_.begin(), iter));
+        const int index = static_cast<int>(std::distance(keyframes.begin(), iter));
 
-        if (iter == keyframes_.end()) return {index - 1, std::prev(iter)->value};
+        if (iter == keyframes.end()) return {index - 1, std::prev(iter)->value};
 
-        if (iter == keyframes_.begin()) return {index, iter->value};
+        if (iter == keyframes.begin()) return {index, iter->value};
 
         auto prev = std::prev(iter);
         float value = prev->value + (iter->value - prev->value) / (iter->time - prev->time) * (current.time - prev->time);
@@ -139,9 +375,43 @@ public:
         return {index - 1, value};
     }
 
+    void detach() {
+        if (!shared_keyframes_ && !referenced_keyframes_) return;
+        // Held until copied, since setting the keyframes lets go of them.
+        const auto shared = shared_keyframes_;
+        const auto referenced = referenced_keyframes_;
+        const auto keyframes = this->keyframes();
+        set_keyframes(keyframes.begin(), keyframes.end());
+    }
+
+    void release_referenced() noexcept {
+        referenced_keyframes_.reset();
+        referenced_size_ = 0;
+    }
+
+    void copy_inline(const AnimationCurve &other) noexcept {
+        std::copy(other.inline_keyframes_, other.inline_keyframes_ + other.inline_size_, inline_keyframes_);
+        inline_size_ = other.inline_size_;
+    }
+
 private:
-    std::vector<Keyframe> keyframes_;
+    KeyframeVector keyframes_;
+
+    // When set, the keyframes are shared with other curves and keyframes_ is empty.
+    std::shared_ptr<const KeyframeVector> shared_keyframes_;
+
+    // When set, the keyframes are in memory owned elsewhere and keyframes_ is empty.
+    std::shared_ptr<const Keyframe> referenced_keyframes_;
+    std::size_t referenced_size_{0};
+
+    // Used while keyframes_ is empty and nothing is shared.
+    Keyframe inline_keyframes_[inline_capacity];
+    std::size_t inline_size_{0};
     WrapMode wrap_mode_{WrapMode::Once};
+
+    // The end of the keyframes in ticks, valid while ticks_per_second_ is not zero.
+    std::uint32_t ticks_per_second_{0};
+    std::int64_t end_ticks_{0};
 };
 
 } // namespace nodec_animation
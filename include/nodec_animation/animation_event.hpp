@@ -0,0 +1,29 @@
+#ifndef NODEC_ANIMATION__ANIMATION_EVENT_HPP_
+#define NODEC_ANIMATION__ANIMATION_EVENT_HPP_
+
+#include <cstdint>
+
+namespace nodec_animation {
+
+/**
+ * @brief An event placed on the timeline of a clip.
+ *
+ * The meaning of the id and the payloads is up to the application.
+ */
+struct AnimationEvent {
+    float time;
+    std::uint32_t id;
+    std::int32_t int_payload{0};
+    float float_payload{0.f};
+
+    constexpr bool operator<(const AnimationEvent &other) const noexcept {
+        return time < other.time;
+    }
+
+    constexpr bool operator>(const AnimationEvent &other) const noexcept {
+        return time > other.time;
+    }
+};
+} // namespace nodec_animation
+
+#endif
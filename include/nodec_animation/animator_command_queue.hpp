@@ -0,0 +1,251 @@
+#ifndef NODEC_ANIMATION__ANIMATOR_COMMAND_QUEUE_HPP_
+#define NODEC_ANIMATION__ANIMATOR_COMMAND_QUEUE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <nodec_scene/scene_entity.hpp>
+
+#include "resources/animation_clip.hpp"
+
+namespace nodec_animation {
+
+struct AnimatorCommand {
+    enum class Type : std::uint8_t {
+        /**
+         * @brief Starts the clip on the animator, or restarts the clip it has if none is given.
+         */
+        play,
+        stop,
+        /**
+         * @brief Moves the playback of a started animator to the time in the value.
+         */
+        seek,
+        set_speed,
+    };
+
+    nodec_scene::SceneEntity entity;
+    Type type;
+
+    /**
+     * @brief The time of a seek or the speed of a set_speed.
+     */
+    float value{0.f};
+
+    std::shared_ptr<resources::AnimationClip> clip;
+};
+
+/**
+ * @brief The net effect of all commands drained for one entity, in the order they were pushed.
+ *
+ * A stop cancels an earlier play and seek, and a play cancels an earlier stop and seek.
+ * Later seeks and speeds replace earlier ones.
+ */
+struct CoalescedAnimatorCommand {
+    void apply(const AnimatorCommand &command) {
+        switch (command.type) {
+        case AnimatorCommand::Type::play:
+            play = true;
+            stop = false;
+            seek = false;
+            clip = command.clip;
+            break;
+        case AnimatorCommand::Type::stop:
+            stop = true;
+            play = false;
+            seek = false;
+            clip.reset();
+            break;
+        case AnimatorCommand::Type::seek:
+            seek = true;
+            time = command.value;
+            break;
+        case AnimatorCommand::Type::set_speed:
+            set_speed = true;
+            speed = command.value;
+            break;
+        }
+    }
+
+    nodec_scene::SceneEntity entity;
+    bool play{false};
+    bool stop{false};
+    bool seek{false};
+    bool set_speed{false};
+    float time{0.f};
+    float speed{1.f};
+    std::shared_ptr<resources::AnimationClip> clip;
+};
+
+/**
+ * @brief Collects play, stop, seek and speed requests from any thread, for the AnimatorSystem to apply in its update.
+ *
+ * Pushing is lock-free: commands are linked into a list by a single compare-and-swap. The thread owning the registry
+ * takes the whole list at once and coalesces it per entity, so a burst of requests for one animator costs one change
+ * of its components.
+ *
+ * The nodes of drained commands go back to a pool, also lock-free, from which later pushes take them, so pushing
+ * allocates only while the pool is empty.
+ */
+class AnimatorCommandQueue {
+public:
+    AnimatorCommandQueue() = default;
+
+    AnimatorCommandQueue(const AnimatorCommandQueue &) = delete;
+    AnimatorCommandQueue &operator=(const AnimatorCommandQueue &) = delete;
+
+    ~AnimatorCommandQueue() {
+        free(head_.exchange(nullptr, std::memory_order_acquire));
+        free(pool_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    void play(const nodec_scene::SceneEntity &entity, std::shared_ptr<resources::AnimationClip> clip = nullptr) {
+        push({entity, AnimatorCommand::Type::play, 0.f, std::move(clip)});
+    }
+
+    void stop(const nodec_scene::SceneEntity &entity) {
+        push({entity, AnimatorCommand::Type::stop});
+    }
+
+    void seek(const nodec_scene::SceneEntity &entity, float time) {
+        push({entity, AnimatorCommand::Type::seek, time});
+    }
+
+    void set_speed(const nodec_scene::SceneEntity &entity, float speed) {
+        push({entity, AnimatorCommand::Type::set_speed, speed});
+    }
+
+    /**
+     * @brief Pushes the command. Safe to call from any number of threads concurrently.
+     */
+    void push(AnimatorCommand command) {
+        auto *node = acquire();
+        node->command = std::move(command);
+        node->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    /**
+     * @brief Takes all commands pushed so far and coalesces them per entity, replacing the contents of commands.
+     *
+     * The entities are in the order of their first command. Only one thread may drain at a time.
+     */
+    void drain(std::vector<CoalescedAnimatorCommand> &commands) {
+        commands.clear();
+
+        // The list is linked newest first.
+        drained_.clear();
+        auto *first = head_.exchange(nullptr, std::memory_order_acquire);
+        Node *last = nullptr;
+        for (auto *node = first; node; node = node->next) {
+            drained_.push_back(node);
+            last = node;
+        }
+        std::reverse(drained_.begin(), drained_.end());
+
+        // Sorted by entity and then by the order of pushing, which keeps the commands of an entity in order
+        // without the allocations of a hash map.
+        order_.clear();
+        for (std::size_t i = 0; i < drained_.size(); ++i) {
+            order_.emplace_back(entity_key(drained_[i]->command.entity), i);
+        }
+        std::sort(order_.begin(), order_.end());
+
+        // The commands of each entity, by the position of its first command.
+        groups_.clear();
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            if (i == 0 || order_[i].first != order_[i - 1].first) groups_.emplace_back(order_[i].second, i);
+        }
+        std::sort(groups_.begin(), groups_.end());
+
+        for (const auto &group : groups_) {
+            commands.emplace_back();
+            auto &coalesced = commands.back();
+            coalesced.entity = drained_[group.first]->command.entity;
+            const auto key = order_[group.second].first;
+            for (auto i = group.second; i < order_.size() && order_[i].first == key; ++i) {
+                coalesced.apply(drained_[order_[i].second]->command);
+            }
+        }
+
+        // The nodes keep no clips alive in the pool.
+        for (auto *node : drained_) node->command.clip.reset();
+        drained_.clear();
+        if (first) recycle(first, last);
+    }
+
+private:
+    struct Node {
+        AnimatorCommand command;
+        Node *next{nullptr};
+    };
+
+    /**
+     * @brief Takes a node from the pool, or allocates one if the pool is empty.
+     *
+     * The whole pool is taken at once and the rest put back, since unlinking a single node could race with
+     * the node being pushed, drained and recycled by other threads in between (ABA).
+     */
+    Node *acquire() {
+        auto *node = pool_.exchange(nullptr, std::memory_order_acquire);
+        if (!node) return new Node();
+
+        if (auto *rest = node->next) {
+            Node *expected = nullptr;
+            if (!pool_.compare_exchange_strong(expected, rest, std::memory_order_release, std::memory_order_relaxed)) {
+                // Nodes have been put into the pool meanwhile, so the rest is linked in front of them.
+                auto *last = rest;
+                while (last->next) last = last->next;
+                recycle(rest, last);
+            }
+        }
+        return node;
+    }
+
+    /**
+     * @brief Puts the nodes linked from first to last into the pool.
+     */
+    void recycle(Node *first, Node *last) {
+        last->next = pool_.load(std::memory_order_relaxed);
+        while (!pool_.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void free(Node *node) {
+        while (node) {
+            auto *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    static std::uint32_t entity_key(const nodec_scene::SceneEntity &entity) noexcept {
+        static_assert(sizeof(nodec_scene::SceneEntity) == sizeof(std::uint32_t), "Entities are expected to be 32-bit.");
+        std::uint32_t key;
+        std::memcpy(&key, &entity, sizeof(key));
+        return key;
+    }
+
+private:
+    std::atomic<Node *> head_{nullptr};
+    std::atomic<Node *> pool_{nullptr};
+    std::vector<Node *> drained_;
+    // The key of the entity and the position of the command.
+    std::vector<std::pair<std::uint32_t, std::size_t>> order_;
+    // The position of the first command of an entity and the index of that command in order_.
+    std::vector<std::pair<std::size_t, std::size_t>> groups_;
+};
+
+} // namespace nodec_animation
+
+#endif
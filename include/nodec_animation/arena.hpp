@@ -0,0 +1,208 @@
+#ifndef NODEC_ANIMATION__ARENA_HPP_
+#define NODEC_ANIMATION__ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#    include <sys/mman.h>
+#endif
+
+namespace nodec_animation {
+
+/**
+ * @brief A monotonic memory arena.
+ *
+ * Memory is carved out of large blocks and only given back all at once, when the arena is released or destroyed.
+ * Everything allocated from one arena therefore lies in a few contiguous blocks.
+ */
+class MonotonicArena {
+public:
+    static constexpr std::size_t default_block_size = 64 * 1024;
+    static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    /**
+     * @param huge_pages Backs the blocks with transparent huge pages where the platform supports them,
+     * which saves TLB misses when the arena is walked as a whole. Blocks are then rounded up to huge_page_size.
+     */
+    explicit MonotonicArena(std::size_t block_size = default_block_size, bool huge_pages = false)
+        : block_size_(block_size), huge_pages_(huge_pages) {}
+
+    ~MonotonicArena() {
+        release();
+    }
+
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+    void *allocate(std::size_t size, std::size_t alignment) {
+        auto aligned = align_up(cursor_, alignment);
+        if (!head_ || end_ < aligned + size) {
+            grow(size + alignment);
+            aligned = align_up(cursor_, alignment);
+        }
+        cursor_ = aligned + size;
+        allocated_bytes_ += size;
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    /**
+     * @brief Frees all blocks. Everything allocated from the arena becomes invalid.
+     */
+    void release() noexcept {
+        while (head_) {
+            auto *next = head_->next;
+            free_block(head_);
+            head_ = next;
+        }
+        cursor_ = end_ = 0;
+        allocated_bytes_ = reserved_bytes_ = 0;
+        block_count_ = 0;
+    }
+
+    /**
+     * @brief Returns the bytes handed out so far, without alignment padding.
+     */
+    std::size_t allocated_bytes() const noexcept {
+        return allocated_bytes_;
+    }
+
+    /**
+     * @brief Returns the bytes of all blocks owned by the arena.
+     */
+    std::size_t reserved_bytes() const noexcept {
+        return reserved_bytes_;
+    }
+
+    std::size_t block_count() const noexcept {
+        return block_count_;
+    }
+
+private:
+    struct Block {
+        Block *next;
+        std::size_t size;
+        bool mapped;
+    };
+
+    static std::uintptr_t align_up(std::uintptr_t address, std::size_t alignment) noexcept {
+        return (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+
+    void grow(std::size_t minimum_size) {
+        auto size = sizeof(Block) + (minimum_size < block_size_ ? block_size_ : minimum_size);
+        auto *block = huge_pages_ ? allocate_huge_block(size) : nullptr;
+        if (!block) {
+            block = static_cast<Block *>(::operator new(size));
+            block->mapped = false;
+        }
+        block->next = head_;
+        block->size = size;
+        head_ = block;
+
+        cursor_ = reinterpret_cast<std::uintptr_t>(block) + sizeof(Block);
+        end_ = reinterpret_cast<std::uintptr_t>(block) + size;
+        reserved_bytes_ += size;
+        ++block_count_;
+    }
+
+    static Block *allocate_huge_block(std::size_t &size) {
+#ifdef __linux__
+        size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void *data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) return nullptr;
+#    ifdef MADV_HUGEPAGE
+        // Only a hint. Without transparent huge pages the block stays on normal pages.
+        ::madvise(data, size, MADV_HUGEPAGE);
+#    endif
+        auto *block = static_cast<Block *>(data);
+        block->mapped = true;
+        return block;
+#else
+        (void)size;
+        return nullptr;
+#endif
+    }
+
+    static void free_block(Block *block) noexcept {
+#ifdef __linux__
+        if (block->mapped) {
+            ::munmap(block, block->size);
+            return;
+        }
+#endif
+        ::operator delete(block);
+    }
+
+private:
+    std::size_t block_size_;
+    bool huge_pages_;
+    Block *head_{nullptr};
+    std::uintptr_t cursor_{0};
+    std::uintptr_t end_{0};
+    std::size_t allocated_bytes_{0};
+    std::size_t reserved_bytes_{0};
+    std::size_t block_count_{0};
+};
+
+/**
+ * @brief Allocator allocating from a MonotonicArena, or from the global heap when it has no arena.
+ *
+ * Copies of containers using this allocator do not inherit the arena,
+ * so data copied out of an arena does not depend on its lifetime.
+ */
+template<class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+
+    ArenaAllocator() noexcept {}
+
+    ArenaAllocator(MonotonicArena *arena) noexcept
+        : arena_(arena) {}
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+        : arena_(other.arena()) {}
+
+    T *allocate(std::size_t n) {
+        if (!arena_) return static_cast<T *>(::operator new(n * sizeof(T)));
+        return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, std::size_t) noexcept {
+        // Memory of an arena is freed all at once.
+        if (!arena_) ::operator delete(pointer);
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const noexcept {
+        return ArenaAllocator();
+    }
+
+    MonotonicArena *arena() const noexcept {
+        return arena_;
+    }
+
+private:
+    MonotonicArena *arena_{nullptr};
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept {
+    return lhs.arena() == rhs.arena();
+}
+
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+} // namespace nodec_animation
+
+#endif
@@ -2,6 +2,7 @@
 #define NODEC_ANIMATION__COMPONENT_REGISTRY_HPP_
 
 #include <memory>
+#include <typeinfo>
 
 #include <nodec/type_info.hpp>
 #include <nodec_scene/scene_registry.hpp>
@@ -20,23 +21,47 @@ public:
         virtual void write_properties(nodec_scene::SceneRegistry &registry,
                                       const nodec_scene::SceneEntity &entity,
                                       const nodec_animation::resources::AnimatedComponent &source,
-                                      float time,
-                                      AnimatedComponentWriter::ComponentAnimationState *state = nullptr) const = 0;
+                                      PlaybackTime time,
+                                      AnimatedComponentWriter &writer,
+                                      AnimatedComponentWriter::ComponentAnimationState *state = nullptr,
+                                      float weight = 1.f) const = 0;
+
+        void write_properties(nodec_scene::SceneRegistry &registry,
+                              const nodec_scene::SceneEntity &entity,
+                              const nodec_animation::resources::AnimatedComponent &source,
+                              PlaybackTime time,
+                              AnimatedComponentWriter::ComponentAnimationState *state = nullptr,
+                              float weight = 1.f) const {
+            AnimatedComponentWriter writer;
+            write_properties(registry, entity, source, time, writer, state, weight);
+        }
+
+        /**
+         * @brief Name of the component type, used for trace zones.
+         */
+        virtual const char *type_name() const noexcept = 0;
     };
 
     template<class Component>
     class AnimationHandler : public BaseAnimationHandler {
     public:
+        using BaseAnimationHandler::write_properties;
+
         void write_properties(nodec_scene::SceneRegistry &registry,
                               const nodec_scene::SceneEntity &entity,
                               const nodec_animation::resources::AnimatedComponent &source,
-                              float time,
-                              AnimatedComponentWriter::ComponentAnimationState *state = nullptr) const override {
+                              PlaybackTime time,
+                              AnimatedComponentWriter &writer,
+                              AnimatedComponentWriter::ComponentAnimationState *state = nullptr,
+                              float weight = 1.f) const override {
             auto *component = registry.try_get_component<Component>(entity);
             if (!component) return;
 
-            AnimatedComponentWriter writer;
-            writer.write(source, time, *component, state);
+            writer.write(source, time, *component, state, weight);
+        }
+
+        const char *type_name() const noexcept override {
+            return typeid(Component).name();
         }
     };
 
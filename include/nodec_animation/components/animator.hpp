@@ -1,21 +1,62 @@
 #ifndef NODEC_ANIMATION__COMPONENTS__ANIMATOR_HPP_
 #define NODEC_ANIMATION__COMPONENTS__ANIMATOR_HPP_
 
+#include <cstdint>
 #include <memory>
 
 #include "../resources/animation_clip.hpp"
+#include "../resources/async_clip_loader.hpp"
 
 namespace nodec_animation {
 namespace components {
 
 struct Animator {
     std::shared_ptr<resources::AnimationClip> clip;
+
+    /**
+     * @brief Playback speed applied at AnimatorStart.
+     *
+     * A negative speed plays the clip in reverse, starting from its end.
+     */
+    float speed{1.f};
+
+    /**
+     * @brief The clip being loaded in the background, if any.
+     *
+     * While it is not ready, AnimatorStart is kept and the start is deferred.
+     * Once ready, its clip replaces the clip above and the request is cleared.
+     * AnimatorStop clears the request and cancels the deferred start.
+     */
+    std::shared_ptr<resources::ClipRequest> clip_request;
 };
 
 struct AnimatorStart {};
 
 struct AnimatorStop {};
 
+/**
+ * @brief Marker emplaced on the animator entity when a non-looping clip has played to its end.
+ *
+ * It is removed again by AnimatorStart or AnimatorStop.
+ */
+struct AnimatorFinished {};
+
+/**
+ * @brief Marks an animated entity whose pose is only written on request, by AnimatorSystem::evaluate().
+ *
+ * The update only advances its time and remembers the time of the pose which would have been written.
+ * Remove it to have the entity written by every update again.
+ */
+struct LazyEvaluation {
+    /**
+     * @brief Whether the pose at the time below has not been written yet.
+     */
+    bool pending{false};
+
+    float time{0.f};
+    std::int64_t ticks{0};
+};
+
 } // namespace components
 } // namespace nodec_animation
 
@@ -0,0 +1,57 @@
+#ifndef NODEC_ANIMATION__COMPONENTS__ANIMATOR_CONTROLLER_HPP_
+#define NODEC_ANIMATION__COMPONENTS__ANIMATOR_CONTROLLER_HPP_
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "../resources/animator_description.hpp"
+
+namespace nodec_animation {
+namespace components {
+
+/**
+ * @brief Plays the state machine of an AnimatorDescription.
+ *
+ * It is started and stopped by AnimatorStart and AnimatorStop like the Animator.
+ * The parameters are initialized with their default values at start.
+ */
+struct AnimatorController {
+    std::shared_ptr<resources::AnimatorDescription> description;
+
+    /**
+     * @brief Parameter values indexed like AnimatorDescription::parameters().
+     */
+    std::vector<float> parameters;
+
+    void set_float(int parameter, float value) {
+        assert(0 <= parameter && parameter < static_cast<int>(parameters.size()));
+        parameters[parameter] = value;
+    }
+
+    void set_int(int parameter, int value) {
+        set_float(parameter, static_cast<float>(value));
+    }
+
+    void set_bool(int parameter, bool value) {
+        set_float(parameter, value ? 1.f : 0.f);
+    }
+
+    void set_trigger(int parameter) {
+        set_bool(parameter, true);
+    }
+
+    void reset_trigger(int parameter) {
+        set_bool(parameter, false);
+    }
+
+    float get_float(int parameter) const {
+        assert(0 <= parameter && parameter < static_cast<int>(parameters.size()));
+        return parameters[parameter];
+    }
+};
+
+} // namespace components
+} // namespace nodec_animation
+
+#endif
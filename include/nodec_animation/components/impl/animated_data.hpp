@@ -2,20 +2,83 @@
 #define NODEC_ANIMATION__COMPONENTS__IMPL__ANIMATED_DATA_HPP_
 
 #include "../../animated_component_writer.hpp"
+#include "../../property_mask.hpp"
 #include "../../resources/animation_clip.hpp"
 
 namespace nodec_animation {
 namespace components {
 namespace impl {
 
+using ComponentAnimationStates = std::unordered_map<nodec::type_info, AnimatedComponentWriter::ComponentAnimationState>;
+
+/**
+ * @brief Binds the states to the properties of the animated entity to write, which are all of them,
+ * or only the included ones if given. The states of other components are dropped.
+ */
+inline void bind_animation_states(ComponentAnimationStates &states, const resources::AnimatedEntity &animated_entity,
+                                  const MaskedEntityTree::IncludedEntity *included, bool keep_hints) {
+    for (auto iter = states.begin(); iter != states.end();) {
+        const bool bound = included ? included->components.count(iter->first) != 0
+                                    : animated_entity.components.count(iter->first) != 0;
+        iter = bound ? std::next(iter) : states.erase(iter);
+    }
+
+    if (included) {
+        for (const auto &component : included->components) {
+            states[component.first].bind(*component.second.source, component.second.properties, keep_hints);
+        }
+        return;
+    }
+    for (const auto &component : animated_entity.components) {
+        states[component.first].bind(component.second, component.second.properties, keep_hints);
+    }
+}
+
 struct AnimatedData {
+    /**
+     * @brief Binds the data to the animated entity and creates the animation states of all its properties,
+     * or of the included ones if given, up front.
+     *
+     * The states of a previous binding to the same animated entity are reused.
+     */
     void reset(std::shared_ptr<resources::AnimationClip> clip,
-               const resources::AnimatedEntity *animated_entity) {
+               const resources::AnimatedEntity *animated_entity,
+               const MaskedEntityTree::IncludedEntity *included = nullptr) {
+        if (animated_entity_ != animated_entity) {
+            component_animation_states.clear();
+        }
         clip_ = clip;
         animated_entity_ = animated_entity;
+        clip_version_ = clip ? clip->version() : 0;
+        time = 0.f;
+        ticks = 0;
+
+        if (!animated_entity) return;
+        bind_animation_states(component_animation_states, *animated_entity, included, false);
     }
 
-    std::shared_ptr<resources::AnimationClip> clip() const noexcept {
+    /**
+     * @brief Binds the data to the entity of the changed clip which now animates the same scene entity.
+     *
+     * The time and the states of the components and properties still animated are kept.
+     */
+    void remap(const resources::AnimatedEntity *animated_entity,
+               const MaskedEntityTree::IncludedEntity *included = nullptr) {
+        animated_entity_ = animated_entity;
+        clip_version_ = clip_->version();
+        bind_animation_states(component_animation_states, *animated_entity, included, true);
+    }
+
+    /**
+     * @brief Drops the clip before the data is pooled.
+     *
+     * The animated entity is only kept to tell whether the states can be reused by the next reset().
+     */
+    void release() noexcept {
+        clip_.reset();
+    }
+
+    const std::shared_ptr<resources::AnimationClip> &clip() const noexcept {
         return clip_;
     }
 
@@ -23,15 +86,50 @@ struct AnimatedData {
         return animated_entity_;
     }
 
-    std::unordered_map<nodec::type_info, AnimatedComponentWriter::ComponentAnimationState>
-        component_animation_states;
+    /**
+     * @brief The version of the clip the data has been bound to. Until it is remapped,
+     * the data of a changed clip must not be evaluated, since its animated entity may be gone.
+     */
+    std::uint32_t clip_version() const noexcept {
+        return clip_version_;
+    }
+
+    bool is_stale() const noexcept {
+        return clip_ && clip_version_ != clip_->version();
+    }
+
+    ComponentAnimationStates component_animation_states;
 
     float time{0.f};
 
+    /**
+     * @brief Playback time in ticks, used instead of the time when the system runs in a tick time base.
+     * The time then only follows it approximately.
+     */
+    std::int64_t ticks{0};
+    float speed{1.f};
+
+    /**
+     * @brief The update in which the system has last visited the data in its evaluation order.
+     */
+    std::uint32_t evaluation_stamp{0};
+
 private:
     std::shared_ptr<resources::AnimationClip> clip_;
     const resources::AnimatedEntity *animated_entity_{nullptr};
+    std::uint32_t clip_version_{0};
 };
+
+/**
+ * @brief Holds the AnimatedData of an entity whose clip has finished.
+ *
+ * Finished entities are moved out of the AnimatedData pool so that they are not visited
+ * by the per-frame evaluation at all, and moved back when the animator is restarted.
+ */
+struct SleepingAnimatedData {
+    AnimatedData data;
+};
+
 } // namespace impl
 } // namespace components
 } // namespace nodec_animation
@@ -1,6 +1,7 @@
 #ifndef NODEC_ANIMATION__COMPONENTS__IMPL__ANIMATOR_ACTIVITY_HPP_
 #define NODEC_ANIMATION__COMPONENTS__IMPL__ANIMATOR_ACTIVITY_HPP_
 
+#include <cstdint>
 #include <memory>
 
 #include <nodec_scene/scene_entity.hpp>
@@ -13,7 +14,43 @@ namespace impl {
 
 struct AnimatorActivity {
     std::shared_ptr<resources::AnimationClip> clip;
+
+    /**
+     * @brief The version of the clip the animated entities are bound to.
+     */
+    std::uint32_t clip_version{0};
+
     std::vector<nodec_scene::SceneEntity> animated_entities;
+
+    /**
+     * @brief True while the clip has finished and all animated entities are sleeping.
+     */
+    bool sleeping{false};
+
+    /**
+     * @brief Playback time of the animator, kept in step with the time of its AnimatedData.
+     */
+    float time{0.f};
+
+    /**
+     * @brief Playback time in ticks when the system runs in a tick time base.
+     *
+     * It is kept within one loop of a looping clip, so that the time derived from it stays exact.
+     */
+    std::int64_t ticks{0};
+    float speed{1.f};
+
+    /**
+     * @brief Time up to which the events of the clip have been fired.
+     */
+    float event_time{0.f};
+
+    /**
+     * @brief Index into the sorted events of the clip.
+     *
+     * The events before the cursor have already been passed in the current loop.
+     */
+    std::size_t event_cursor{0};
 };
 
 } // namespace impl
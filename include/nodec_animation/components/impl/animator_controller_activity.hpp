@@ -0,0 +1,63 @@
+#ifndef NODEC_ANIMATION__COMPONENTS__IMPL__ANIMATOR_CONTROLLER_ACTIVITY_HPP_
+#define NODEC_ANIMATION__COMPONENTS__IMPL__ANIMATOR_CONTROLLER_ACTIVITY_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <nodec_scene/scene_entity.hpp>
+
+#include "../../animated_component_writer.hpp"
+#include "../../resources/animator_description.hpp"
+
+namespace nodec_animation {
+namespace components {
+namespace impl {
+
+struct AnimatorControllerActivity {
+    struct Binding {
+        nodec_scene::SceneEntity entity;
+        const resources::AnimatedEntity *animated_entity;
+        std::unordered_map<nodec::type_info, AnimatedComponentWriter::ComponentAnimationState>
+            component_animation_states;
+    };
+
+    std::shared_ptr<resources::AnimatorDescription> description;
+    std::uint32_t description_version{0};
+
+    /**
+     * @brief Bindings of all clips of the description, grouped by clip.
+     *
+     * The bindings of the clip i are in the range [binding_offsets[i], binding_offsets[i + 1]).
+     */
+    std::vector<Binding> bindings;
+    std::vector<std::uint32_t> binding_offsets;
+
+    /**
+     * @brief The versions of the clips the bindings were made for, indexed like the clips of the description.
+     */
+    std::vector<std::uint32_t> clip_versions;
+
+    int current_state{-1};
+    float current_time{0.f};
+
+    /**
+     * @brief Playback time of the current state in ticks when the system runs in a tick time base.
+     */
+    std::int64_t current_ticks{0};
+
+    /**
+     * @brief The destination of the running crossfade, or -1.
+     */
+    int next_state{-1};
+    float next_time{0.f};
+    std::int64_t next_ticks{0};
+    float transition_elapsed{0.f};
+    float transition_duration{0.f};
+};
+
+} // namespace impl
+} // namespace components
+} // namespace nodec_animation
+#endif
@@ -1,7 +1,10 @@
 #ifndef NODEC_ANIMATION__KEYFRAME_HPP_
 #define NODEC_ANIMATION__KEYFRAME_HPP_
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace nodec_animation {
 
@@ -17,6 +20,85 @@ struct Keyframe {
         return time > other.time;
     }
 };
+
+inline constexpr bool operator==(const Keyframe &lhs, const Keyframe &rhs) noexcept {
+    return lhs.time == rhs.time && lhs.value == rhs.value;
+}
+
+inline constexpr bool operator!=(const Keyframe &lhs, const Keyframe &rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+/**
+ * @brief A read-only view of contiguous keyframes, sorted by time.
+ *
+ * It compares by the keyframes viewed, also with a vector of keyframes, and converts explicitly
+ * to a vector holding a copy of them.
+ */
+class KeyframeSpan {
+public:
+    using value_type = Keyframe;
+    using size_type = std::size_t;
+    using iterator = const Keyframe *;
+    using const_iterator = const Keyframe *;
+
+    constexpr KeyframeSpan() noexcept {}
+
+    constexpr KeyframeSpan(const Keyframe *data, std::size_t size) noexcept
+        : data_(data), size_(size) {}
+
+    KeyframeSpan(const std::vector<Keyframe> &keyframes) noexcept
+        : data_(keyframes.data()), size_(keyframes.size()) {}
+
+    explicit operator std::vector<Keyframe>() const {
+        return std::vector<Keyframe>(begin(), end());
+    }
+
+    constexpr const Keyframe *begin() const noexcept {
+        return data_;
+    }
+
+    constexpr const Keyframe *end() const noexcept {
+        return data_ + size_;
+    }
+
+    constexpr const Keyframe *data() const noexcept {
+        return data_;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return size_;
+    }
+
+    constexpr bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr const Keyframe &operator[](std::size_t index) const noexcept {
+        return data_[index];
+    }
+
+    constexpr const Keyframe &front() const noexcept {
+        return data_[0];
+    }
+
+    constexpr const Keyframe &back() const noexcept {
+        return data_[size_ - 1];
+    }
+
+private:
+    const Keyframe *data_{nullptr};
+    std::size_t size_{0};
+};
+
+inline bool operator==(KeyframeSpan lhs, KeyframeSpan rhs) noexcept {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+inline bool operator!=(KeyframeSpan lhs, KeyframeSpan rhs) noexcept {
+    return !(lhs == rhs);
+}
+
 } // namespace nodec_animation
 
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef NODEC_ANIMATION__PARALLEL_EXECUTOR_HPP_
+#define NODEC_ANIMATION__PARALLEL_EXECUTOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace nodec_animation {
+
+/**
+ * @brief Interface running independent jobs of the animation systems in parallel, e.g. on the job system of an engine.
+ */
+class ParallelExecutor {
+public:
+    virtual ~ParallelExecutor() {}
+
+    /**
+     * @brief Calls the job with every index in [0, count) and returns once all calls have returned.
+     *
+     * The calls may run concurrently and in any order.
+     */
+    virtual void run(std::size_t count, const std::function<void(std::size_t)> &job) = 0;
+};
+
+/**
+ * @brief Runs the jobs on threads started for each run, the calling thread being one of them.
+ *
+ * Starting threads costs some tens of microseconds, which is meant to pay off in the rare updates
+ * with a lot of work, such as binding thousands of animators spawned at once.
+ */
+class ThreadParallelExecutor : public ParallelExecutor {
+public:
+    explicit ThreadParallelExecutor(unsigned thread_count = std::thread::hardware_concurrency())
+        : thread_count_(thread_count == 0 ? 1 : thread_count) {}
+
+    void run(std::size_t count, const std::function<void(std::size_t)> &job) override {
+        std::atomic<std::size_t> next{0};
+        auto work = [&]() {
+            for (auto index = next++; index < count; index = next++) job(index);
+        };
+
+        if (count == 0) return;
+        const auto helper_count = (std::min)(static_cast<std::size_t>(thread_count_ - 1), count - 1);
+        std::vector<std::thread> helpers;
+        helpers.reserve(helper_count);
+        for (std::size_t i = 0; i < helper_count; ++i) helpers.emplace_back(work);
+        work();
+        for (auto &helper : helpers) helper.join();
+    }
+
+private:
+    unsigned thread_count_;
+};
+
+} // namespace nodec_animation
+
+#endif
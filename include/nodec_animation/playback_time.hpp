@@ -0,0 +1,49 @@
+#ifndef NODEC_ANIMATION__PLAYBACK_TIME_HPP_
+#define NODEC_ANIMATION__PLAYBACK_TIME_HPP_
+
+#include <cmath>
+#include <cstdint>
+
+namespace nodec_animation {
+
+inline std::int64_t seconds_to_ticks(double seconds, std::uint32_t ticks_per_second) noexcept {
+    return static_cast<std::int64_t>(std::llround(seconds * ticks_per_second));
+}
+
+inline double ticks_to_seconds(std::int64_t ticks, std::uint32_t ticks_per_second) noexcept {
+    return static_cast<double>(ticks) / ticks_per_second;
+}
+
+/**
+ * @brief The time at which a clip is evaluated, either in seconds or in integer ticks.
+ *
+ * Times in ticks do not lose precision however long playback runs, and looping curves wrap them
+ * by integer arithmetic. The seconds of a time in ticks are only an approximation.
+ */
+struct PlaybackTime {
+    PlaybackTime(float seconds) noexcept
+        : seconds(seconds) {}
+
+    static PlaybackTime from_ticks(std::int64_t ticks, std::uint32_t ticks_per_second) noexcept {
+        PlaybackTime time(static_cast<float>(ticks_to_seconds(ticks, ticks_per_second)));
+        time.ticks = ticks;
+        time.ticks_per_second = ticks_per_second;
+        return time;
+    }
+
+    bool in_ticks() const noexcept {
+        return ticks_per_second > 0;
+    }
+
+    float seconds;
+    std::int64_t ticks{0};
+
+    /**
+     * @brief Zero if the time is given in seconds only.
+     */
+    std::uint32_t ticks_per_second{0};
+};
+
+} // namespace nodec_animation
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef NODEC_ANIMATION__PROPERTY_MASK_HPP_
+#define NODEC_ANIMATION__PROPERTY_MASK_HPP_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nodec/type_info.hpp>
+
+#include "resources/animation_clip.hpp"
+
+namespace nodec_animation {
+
+/**
+ * @brief The part of an entity tree which a PropertyMask includes.
+ *
+ * It refers to the properties of the tree instead of copying them, so curves changed in place, e.g. through
+ * AnimationClip::find_curve() or update_curves(), are evaluated as they are. It is valid as long as the tree is.
+ */
+class MaskedEntityTree {
+public:
+    struct IncludedComponent {
+        const resources::AnimatedComponent *source{nullptr};
+        std::vector<const resources::AnimatedComponent::PropertyMap::value_type *> properties;
+    };
+
+    struct IncludedEntity {
+        std::unordered_map<nodec::type_info, IncludedComponent> components;
+    };
+
+    /**
+     * @brief Returns the included properties of the entity, or nullptr if neither it nor any entity below it has any.
+     */
+    const IncludedEntity *find(const resources::AnimatedEntity &animated_entity) const {
+        auto iter = entities_.find(&animated_entity);
+        return iter != entities_.end() ? &iter->second : nullptr;
+    }
+
+private:
+    friend class PropertyMask;
+
+    std::unordered_map<const resources::AnimatedEntity *, IncludedEntity> entities_;
+};
+
+/**
+ * @brief Selects the animated properties which are evaluated, e.g. only the gameplay relevant ones on a server.
+ *
+ * A rule names a component type and optionally a property path. A path also covers the properties nested below it,
+ * so "position" covers "position.x". Without any include rule everything is included, otherwise only what an include
+ * rule covers. Exclude rules take precedence over include rules.
+ */
+class PropertyMask {
+public:
+    template<class Component>
+    PropertyMask &include(const std::string &property_path = std::string()) {
+        return include(nodec::type_id<Component>(), property_path);
+    }
+
+    PropertyMask &include(const nodec::type_info &component_type, const std::string &property_path = std::string()) {
+        included_[component_type].push_back(property_path);
+        return *this;
+    }
+
+    template<class Component>
+    PropertyMask &exclude(const std::string &property_path = std::string()) {
+        return exclude(nodec::type_id<Component>(), property_path);
+    }
+
+    PropertyMask &exclude(const nodec::type_info &component_type, const std::string &property_path = std::string()) {
+        excluded_[component_type].push_back(property_path);
+        return *this;
+    }
+
+    /**
+     * @brief Returns true if the mask has no rules, i.e. includes everything.
+     */
+    bool empty() const noexcept {
+        return included_.empty() && excluded_.empty();
+    }
+
+    bool includes(const nodec::type_info &component_type, const std::string &property_name) const {
+        if (covers(excluded_, component_type, property_name)) return false;
+        return included_.empty() || covers(included_, component_type, property_name);
+    }
+
+    /**
+     * @brief Collects the included properties of the entity tree into dest.
+     *
+     * Entities without any included property in or below them are left out, so that they are not bound at all.
+     *
+     * @return false if nothing in the tree is included.
+     */
+    bool apply(const resources::AnimatedEntity &source, MaskedEntityTree &dest) const {
+        MaskedEntityTree::IncludedEntity included;
+        for (const auto &component : source.components) {
+            for (const auto &property : component.second.properties) {
+                if (!includes(component.first, property.first)) continue;
+                auto &included_component = included.components[component.first];
+                included_component.source = &component.second;
+                included_component.properties.push_back(&property);
+            }
+        }
+
+        bool any_child = false;
+        for (const auto &child : source.children) {
+            if (apply(child.second, dest)) any_child = true;
+        }
+
+        if (included.components.empty() && !any_child) return false;
+        dest.entities_.emplace(&source, std::move(included));
+        return true;
+    }
+
+private:
+    using Rules = std::unordered_map<nodec::type_info, std::vector<std::string>>;
+
+    static bool covers(const Rules &rules, const nodec::type_info &component_type, const std::string &property_name) {
+        auto iter = rules.find(component_type);
+        if (iter == rules.end()) return false;
+
+        for (const auto &path : iter->second) {
+            if (path.empty()) return true;
+            if (property_name.compare(0, path.size(), path) != 0) continue;
+            if (property_name.size() == path.size() || property_name[path.size()] == '.') return true;
+        }
+        return false;
+    }
+
+private:
+    Rules included_;
+    Rules excluded_;
+};
+
+} // namespace nodec_animation
+
+#endif
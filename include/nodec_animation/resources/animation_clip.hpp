@@ -1,33 +1,139 @@
 #ifndef NODEC_ANIMATION__RESOURCES__ANIMATION_CLIP_HPP_
 #define NODEC_ANIMATION__RESOURCES__ANIMATION_CLIP_HPP_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <scoped_allocator>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <nodec/ranges.hpp>
 #include <nodec/type_info.hpp>
 
 #include "../animation_curve.hpp"
+#include "../arena.hpp"
+#include "../animation_event.hpp"
 
 namespace nodec_animation {
 namespace resources {
 
+// The clip data is allocator-aware, so that a clip can be built into a MonotonicArena.
+// The scoped allocators hand the arena down to the nested containers and curves.
+// Keys are plain strings; short names fit in their inline buffer.
+
+template<class Key, class Value>
+using ArenaMap = std::map<Key, Value, std::less<Key>,
+                          std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const Key, Value>>>>;
+
+template<class Key, class Value>
+using ArenaUnorderedMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+                                             std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const Key, Value>>>>;
+
 struct AnimatedProperty {
+    using allocator_type = ArenaAllocator<Keyframe>;
+
+    AnimatedProperty() {}
+
+    AnimatedProperty(const AnimationCurve &curve)
+        : curve(curve) {}
+
+    explicit AnimatedProperty(const allocator_type &allocator)
+        : curve(allocator) {}
+
+    AnimatedProperty(const AnimationCurve &curve, const allocator_type &allocator)
+        : curve(curve, allocator) {}
+
+    AnimatedProperty(AnimationCurve &&curve)
+        : curve(std::move(curve)) {}
+
+    AnimatedProperty(AnimationCurve &&curve, const allocator_type &allocator)
+        : curve(std::move(curve), allocator) {}
+
+    AnimatedProperty(const AnimatedProperty &other) = default;
+    AnimatedProperty(AnimatedProperty &&other) = default;
+    AnimatedProperty &operator=(const AnimatedProperty &other) = default;
+    AnimatedProperty &operator=(AnimatedProperty &&other) = default;
+
+    AnimatedProperty(const AnimatedProperty &other, const allocator_type &allocator)
+        : curve(other.curve, allocator) {}
+
+    AnimatedProperty(AnimatedProperty &&other, const allocator_type &allocator)
+        : curve(std::move(other.curve), allocator) {}
+
     AnimationCurve curve;
 };
 
 struct AnimatedComponent {
+    using allocator_type = ArenaAllocator<char>;
+    using PropertyMap = ArenaUnorderedMap<std::string, AnimatedProperty>;
+
+    AnimatedComponent() {}
+
+    AnimatedComponent(PropertyMap &&properties)
+        : properties(std::move(properties)) {}
+
+    explicit AnimatedComponent(const allocator_type &allocator)
+        : properties(PropertyMap::allocator_type(allocator)) {}
+
+    AnimatedComponent(const AnimatedComponent &other) = default;
+    AnimatedComponent(AnimatedComponent &&other) = default;
+    AnimatedComponent &operator=(const AnimatedComponent &other) = default;
+    AnimatedComponent &operator=(AnimatedComponent &&other) = default;
+
+    AnimatedComponent(const AnimatedComponent &other, const allocator_type &allocator)
+        : properties(other.properties, PropertyMap::allocator_type(allocator)) {}
+
+    AnimatedComponent(AnimatedComponent &&other, const allocator_type &allocator)
+        : properties(std::move(other.properties), PropertyMap::allocator_type(allocator)) {}
+
     // Instead of using a map, I think it would be better to use an index-based approach,
     // and have a map to retrieve the index from a string.
-    std::unordered_map<std::string, AnimatedProperty> properties;
+    PropertyMap properties;
 };
 
 struct AnimatedEntity {
-    std::map<std::string, AnimatedEntity> children;
-    std::unordered_map<nodec::type_info, AnimatedComponent> components;
+    using allocator_type = ArenaAllocator<char>;
+    using ChildMap = ArenaMap<std::string, AnimatedEntity>;
+    using ComponentMap = ArenaUnorderedMap<nodec::type_info, AnimatedComponent>;
+
+    AnimatedEntity() {}
+
+    explicit AnimatedEntity(const allocator_type &allocator)
+        : children(ChildMap::allocator_type(allocator)),
+          components(ComponentMap::allocator_type(allocator)) {}
+
+    AnimatedEntity(const AnimatedEntity &other) = default;
+    AnimatedEntity(AnimatedEntity &&other) = default;
+    AnimatedEntity &operator=(const AnimatedEntity &other) = default;
+    AnimatedEntity &operator=(AnimatedEntity &&other) = default;
+
+    AnimatedEntity(const AnimatedEntity &other, const allocator_type &allocator)
+        : children(other.children, ChildMap::allocator_type(allocator)),
+          components(other.components, ComponentMap::allocator_type(allocator)) {}
+
+    AnimatedEntity(AnimatedEntity &&other, const allocator_type &allocator)
+        : children(std::move(other.children), ChildMap::allocator_type(allocator)),
+          components(std::move(other.components), ComponentMap::allocator_type(allocator)) {}
+
+    ChildMap children;
+    ComponentMap components;
+};
+
+/**
+ * @brief Fills the curves of a clip whose keyframes are not all kept in memory.
+ *
+ * The animator system calls prepare() with the playback time before evaluating the clip.
+ * Afterwards the curves must hold the keyframes around that time.
+ */
+class ClipStream {
+public:
+    virtual ~ClipStream() {}
+
+    virtual void prepare(float time) = 0;
 };
 
 class AnimationClip {
@@ -35,24 +141,35 @@ public:
     AnimationClip() {
     }
 
+    /**
+     * @brief Creates a clip whose curves and entity tree are allocated from the arena.
+     *
+     * The clip keeps the arena alive. An arena may be shared by many clips, for example all clips of one asset bundle,
+     * and is freed at once with the last of them.
+     */
+    explicit AnimationClip(std::shared_ptr<MonotonicArena> arena)
+        : arena_(std::move(arena)),
+          root_entity_(AnimatedEntity::allocator_type(arena_.get())) {
+    }
+
+    /**
+     * @brief Returns the arena of the clip, or nullptr if it lives on the heap.
+     */
+    MonotonicArena *arena() const noexcept {
+        return arena_.get();
+    }
+
     template<class Component>
     void set_curve(const std::string &relative_path, const std::string &property_name, const AnimationCurve &curve) {
-        auto split_string = [](const std::string &s, const char *delim) {
-            // https://gist.github.com/ScottHutchinson/6b699c997a33c33130821922c11d25c3
-            std::vector<std::string> elems;
-            size_t start{};
-            size_t end{};
-
-            do {
-                end = s.find_first_of(delim, start);
-                elems.emplace_back(s.substr(start, end - start));
-                start = end + 1;
-            } while (end != std::string::npos);
-            return elems;
-        };
+        set_curve(relative_path, nodec::type_id<Component>(), property_name, curve);
+    }
+
+    void set_curve(const std::string &relative_path, const nodec::type_info &component_type,
+                   const std::string &property_name, const AnimationCurve &curve) {
+        ++version_;
 
         auto &entity = [&]() -> AnimatedEntity & {
-            const auto parts = split_string(relative_path, "/");
+            const auto parts = split_path(relative_path);
             if (parts[0].empty()) return root_entity_;
 
             AnimatedEntity *current = &root_entity_;
@@ -65,7 +182,76 @@ public:
 
         if (property_name.empty()) return;
 
-        entity.components[nodec::type_id<Component>()].properties[property_name].curve = curve;
+        auto &properties = entity.components[component_type].properties;
+        auto result = properties.emplace(property_name, curve);
+        if (!result.second) {
+            // The replaced curve may have been the one that determined the duration.
+            result.first->second.curve = curve;
+            update_timing();
+            return;
+        }
+        accumulate_timing(curve);
+    }
+
+    /**
+     * @brief Returns the curve of the property, or nullptr if the clip has none.
+     *
+     * Changing the keyframes through the returned curve does not update the duration.
+     */
+    AnimationCurve *find_curve(const std::string &relative_path, const nodec::type_info &component_type,
+                               const std::string &property_name) {
+        // The curve may be changed through the pointer.
+        prepared_ticks_per_second_ = 0;
+
+        AnimatedEntity *entity = &root_entity_;
+        const auto parts = split_path(relative_path);
+        if (!parts[0].empty()) {
+            for (const auto &part : parts) {
+                auto child = entity->children.find(part);
+                if (child == entity->children.end()) return nullptr;
+                entity = &child->second;
+            }
+        }
+
+        auto component = entity->components.find(component_type);
+        if (component == entity->components.end()) return nullptr;
+
+        auto property = component->second.properties.find(property_name);
+        if (property == component->second.properties.end()) return nullptr;
+        return &property->second.curve;
+    }
+
+    /**
+     * @brief Calls the function with every curve of the clip. The duration is updated afterwards.
+     */
+    template<class Function>
+    void update_curves(Function &&function) {
+        prepared_ticks_per_second_ = 0;
+        update_curves(root_entity_, function);
+        update_timing();
+    }
+
+    /**
+     * @brief Converts the ends of all curves to ticks, for evaluation in a tick time base.
+     *
+     * Does nothing if the clip has been prepared for the rate already and not changed since,
+     * so that it may be called whenever an animator of the clip starts.
+     */
+    void prepare_ticks(std::uint32_t ticks_per_second) {
+        if (ticks_per_second == 0 || is_prepared_for_ticks(ticks_per_second)) return;
+
+        // The keyframes stay as they are, so the timing does not need to be updated.
+        auto prepare = [&](AnimationCurve &curve) { curve.prepare_ticks(ticks_per_second); };
+        update_curves(root_entity_, prepare);
+        prepared_ticks_per_second_ = ticks_per_second;
+        prepared_version_ = version_;
+    }
+
+    /**
+     * @brief Returns true if prepare_ticks() has converted all curves to the rate since the clip last changed.
+     */
+    bool is_prepared_for_ticks(std::uint32_t ticks_per_second) const noexcept {
+        return prepared_ticks_per_second_ == ticks_per_second && prepared_version_ == version_;
     }
 
     const AnimatedEntity &root_entity() const {
@@ -73,11 +259,150 @@ public:
     }
 
     void set_root_entity(AnimatedEntity &&entity) {
+        ++version_;
         root_entity_ = std::move(entity);
+        update_timing();
+    }
+
+    /**
+     * @brief Adds an event keeping the events sorted by time.
+     *
+     * Events with the same time are kept in the order they were added.
+     */
+    int add_event(const AnimationEvent &event) {
+        ++version_;
+        auto iter = std::upper_bound(events_.begin(), events_.end(), event);
+        iter = events_.insert(iter, event);
+        duration_ = (std::max)(duration_, event.time);
+        return static_cast<int>(std::distance(events_.begin(), iter));
+    }
+
+    const std::vector<AnimationEvent> &events() const noexcept {
+        return events_;
+    }
+
+    void set_events(std::vector<AnimationEvent> &&events) {
+        ++version_;
+        events_ = std::move(events);
+        std::stable_sort(events_.begin(), events_.end());
+        update_timing();
+    }
+
+    /**
+     * @brief Returns the time of the last keyframe or event in this clip, unless it has been overridden.
+     */
+    float duration() const noexcept {
+        return duration_override_ < 0.f ? duration_ : duration_override_;
+    }
+
+    /**
+     * @brief Overrides the duration, for clips whose curves do not hold all of their keyframes.
+     *
+     * A negative duration restores the one computed from the curves and events.
+     */
+    void set_duration(float duration) noexcept {
+        duration_override_ = duration;
+    }
+
+    /**
+     * @brief Returns true if any curve in this clip loops, i.e. the clip never finishes.
+     */
+    bool is_looping() const noexcept {
+        return looping_;
+    }
+
+    /**
+     * @brief Returns a number which changes whenever curves, entities or events are set or added.
+     *
+     * The animator system remaps the animators bound to the clip when it changes, so a clip may be edited
+     * between updates while it is playing. Changing keyframes through find_curve() or update_curves()
+     * keeps the version, since the bindings stay valid.
+     */
+    std::uint32_t version() const noexcept {
+        return version_;
+    }
+
+    /**
+     * @brief Returns the stream which fills the curves of this clip, or nullptr if they are fully in memory.
+     */
+    ClipStream *stream() const noexcept {
+        return stream_.get();
+    }
+
+    void set_stream(std::unique_ptr<ClipStream> stream) {
+        stream_ = std::move(stream);
     }
 
 private:
+    static std::vector<std::string> split_path(const std::string &s) {
+        // https://gist.github.com/ScottHutchinson/6b699c997a33c33130821922c11d25c3
+        std::vector<std::string> elems;
+        size_t start{};
+        size_t end{};
+
+        do {
+            end = s.find_first_of('/', start);
+            elems.emplace_back(s.substr(start, end - start));
+            start = end + 1;
+        } while (end != std::string::npos);
+        return elems;
+    }
+
+    template<class Function>
+    static void update_curves(AnimatedEntity &entity, Function &function) {
+        for (auto &component : entity.components) {
+            for (auto &property : component.second.properties) {
+                function(property.second.curve);
+            }
+        }
+        for (auto &child : entity.children) {
+            update_curves(child.second, function);
+        }
+    }
+
+    void accumulate_timing(const AnimationCurve &curve) {
+        if (!curve.keyframes().empty()) {
+            duration_ = (std::max)(duration_, curve.keyframes().back().time);
+        }
+        looping_ = looping_ || curve.wrap_mode() == WrapMode::Loop;
+    }
+
+    void accumulate_timing(const AnimatedEntity &entity) {
+        for (const auto &component : entity.components) {
+            for (const auto &property : component.second.properties) {
+                accumulate_timing(property.second.curve);
+            }
+        }
+        for (const auto &child : entity.children) {
+            accumulate_timing(child.second);
+        }
+    }
+
+    void update_timing() {
+        duration_ = 0.f;
+        looping_ = false;
+        accumulate_timing(root_entity_);
+        if (!events_.empty()) {
+            duration_ = (std::max)(duration_, events_.back().time);
+        }
+    }
+
+private:
+    // Declared first, so that the data allocated from it is destroyed before it.
+    std::shared_ptr<MonotonicArena> arena_;
     AnimatedEntity root_entity_;
+    std::vector<AnimationEvent> events_;
+    float duration_{0.f};
+    float duration_override_{-1.f};
+    bool looping_{false};
+    std::uint32_t version_{0};
+
+    // The rate the curves were last prepared for by prepare_ticks(), valid while the version is prepared_version_.
+    std::uint32_t prepared_ticks_per_second_{0};
+    std::uint32_t prepared_version_{0};
+
+    // Declared last, so that it is destroyed while the curves it fills still exist.
+    std::unique_ptr<ClipStream> stream_;
 };
 
 } // namespace resources
@@ -0,0 +1,170 @@
+#ifndef NODEC_ANIMATION__RESOURCES__ANIMATION_CLIP_BUILDER_HPP_
+#define NODEC_ANIMATION__RESOURCES__ANIMATION_CLIP_BUILDER_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nodec/type_info.hpp>
+
+#include "animation_clip.hpp"
+
+namespace nodec_animation {
+namespace resources {
+
+/**
+ * @brief Builds a clip from many curves at once, for import and procedural tools.
+ *
+ * Unlike AnimationClip::set_curve(), the curves are moved into the clip, and the entity of a path is looked up
+ * only from where it differs from the previous path. Adding the curves of one entity after another, as importers
+ * usually do, resolves each path segment about once.
+ */
+class AnimationClipBuilder {
+public:
+    AnimationClipBuilder() {
+        reset();
+    }
+
+    /**
+     * @brief Builds the clip into the arena. See AnimationClip::AnimationClip(std::shared_ptr<MonotonicArena>).
+     */
+    explicit AnimationClipBuilder(std::shared_ptr<MonotonicArena> arena)
+        : arena_(std::move(arena)),
+          root_(AnimatedEntity::allocator_type(arena_.get())) {
+        reset();
+    }
+
+    template<class Component>
+    AnimationClipBuilder &add_curve(const std::string &relative_path, const std::string &property_name,
+                                    AnimationCurve &&curve) {
+        return add_curve(relative_path, nodec::type_id<Component>(), property_name, std::move(curve));
+    }
+
+    /**
+     * @brief Adds the curve of the property, replacing the curve the property already has.
+     */
+    AnimationClipBuilder &add_curve(const std::string &relative_path, const nodec::type_info &component_type,
+                                    const std::string &property_name, AnimationCurve &&curve) {
+        auto &entity = resolve(relative_path);
+        if (property_name.empty()) return *this;
+
+        if (&entity != component_entity_ || !(component_->first == component_type)) {
+            component_entity_ = &entity;
+            // References into unordered maps stay valid when they rehash.
+            component_ = &*entity.components.emplace(component_type, AnimatedComponent()).first;
+        }
+
+        // Looked up first, since a failed emplace may have moved from the curve already.
+        auto &properties = component_->second.properties;
+        auto iter = properties.find(property_name);
+        if (iter != properties.end()) {
+            iter->second.curve = std::move(curve);
+        } else {
+            properties.emplace(property_name, std::move(curve));
+        }
+        ++curve_count_;
+        return *this;
+    }
+
+    AnimationClipBuilder &add_event(const AnimationEvent &event) {
+        events_.push_back(event);
+        return *this;
+    }
+
+    /**
+     * @brief The number of curves added since the last build, including replaced ones.
+     */
+    std::size_t curve_count() const noexcept {
+        return curve_count_;
+    }
+
+    /**
+     * @brief Moves everything added into a new clip. The builder is empty afterwards and may be reused.
+     */
+    std::shared_ptr<AnimationClip> build() {
+        auto clip = arena_ ? std::make_shared<AnimationClip>(arena_) : std::make_shared<AnimationClip>();
+
+        // Both trees use the arena of the clip, so the tree is moved without copying.
+        clip->set_root_entity(std::move(root_));
+        if (!events_.empty()) clip->set_events(std::move(events_));
+
+        reset();
+        return clip;
+    }
+
+private:
+    void reset() {
+        // Cleared rather than assigned, so that the tree keeps the allocator of the arena.
+        root_.children.clear();
+        root_.components.clear();
+        events_.clear();
+        path_.clear();
+        segment_ends_.clear();
+        entities_.assign(1, &root_);
+        component_entity_ = nullptr;
+        component_ = nullptr;
+        curve_count_ = 0;
+    }
+
+    /**
+     * @brief Returns the entity of the path, starting from the deepest entity shared with the previous path.
+     *
+     * Entities are nodes of std::map, so the pointers to the entities of the previous path stay valid.
+     */
+    AnimatedEntity &resolve(const std::string &relative_path) {
+        // Like AnimationClip::set_curve(), a path with an empty first segment names the root.
+        if (relative_path.empty() || relative_path[0] == '/') return root_;
+
+        std::size_t shared = 0;
+        std::size_t begin = 0;
+        while (shared < segment_ends_.size()) {
+            auto end = relative_path.find('/', begin);
+            if (end == std::string::npos) end = relative_path.size();
+            if (end != segment_ends_[shared] || relative_path.compare(begin, end - begin, path_, begin, end - begin) != 0) {
+                break;
+            }
+            ++shared;
+            begin = end + 1;
+            if (end == relative_path.size()) break;
+        }
+
+        segment_ends_.resize(shared);
+        entities_.resize(shared + 1);
+
+        auto *entity = entities_.back();
+        while (begin <= relative_path.size()) {
+            auto end = relative_path.find('/', begin);
+            if (end == std::string::npos) end = relative_path.size();
+
+            key_.assign(relative_path, begin, end - begin);
+            entity = &entity->children[key_];
+            segment_ends_.push_back(end);
+            entities_.push_back(entity);
+            begin = end + 1;
+        }
+
+        path_ = relative_path;
+        return *entity;
+    }
+
+private:
+    // Declared first, so that the tree allocated from it is destroyed before it.
+    std::shared_ptr<MonotonicArena> arena_;
+    AnimatedEntity root_;
+    std::vector<AnimationEvent> events_;
+    std::size_t curve_count_{0};
+
+    // The previous path, and the entity after each of its segments. entities_[0] is the root.
+    std::string path_;
+    std::vector<std::size_t> segment_ends_;
+    std::vector<AnimatedEntity *> entities_;
+    std::string key_;
+
+    const AnimatedEntity *component_entity_{nullptr};
+    AnimatedEntity::ComponentMap::value_type *component_{nullptr};
+};
+
+} // namespace resources
+} // namespace nodec_animation
+
+#endif
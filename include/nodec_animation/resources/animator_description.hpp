@@ -1,13 +1,322 @@
 #ifndef NODEC_ANIMATION__RESOURCES__ANIMATOR_CONTROLLER_HPP_
 #define NODEC_ANIMATION__RESOURCES__ANIMATOR_CONTROLLER_HPP_
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "animation_clip.hpp"
+
 namespace nodec_animation {
 namespace resources {
 
+enum class AnimatorParameterType {
+    Float,
+    Int,
+    Bool,
+    /**
+     * @brief A bool which is reset by the transition consuming it.
+     */
+    Trigger,
+};
+
+enum class AnimatorConditionMode {
+    Greater,
+    Less,
+    Equals,
+    NotEquals,
+    /**
+     * @brief The bool or trigger parameter is set.
+     */
+    If,
+    /**
+     * @brief The bool or trigger parameter is not set.
+     */
+    IfNot,
+};
+
+struct AnimatorParameter {
+    std::string name;
+    AnimatorParameterType type;
+    float default_value;
+};
+
+struct AnimatorCondition {
+    int parameter;
+    AnimatorConditionMode mode;
+    float threshold;
+};
+
+struct AnimatorTransition {
+    int source;
+    int destination;
+
+    /**
+     * @brief Crossfade duration in seconds.
+     */
+    float duration;
+
+    /**
+     * @brief Normalized time of the source state after which the transition may happen.
+     * Negative if the transition has no exit time.
+     *
+     * If the clip of the source state loops, an exit time below 1 is reached again in every loop.
+     */
+    float exit_time;
+
+    std::vector<AnimatorCondition> conditions;
+};
+
+struct AnimatorState {
+    std::string name;
+    std::shared_ptr<AnimationClip> clip;
+    float speed;
+};
+
+/**
+ * @brief The AnimatorDescription describes a state machine of clips.
+ *
+ * States reference clips and are connected by transitions, which happen when all of their
+ * conditions on the parameters hold. Before playback the description is compiled into flat tables,
+ * so that evaluating the transitions of an animator needs neither allocations nor lookups by name.
+ */
 class AnimatorDescription {
+public:
+    struct CompiledState {
+        /**
+         * @brief Index into clips(), or -1 if the state has no clip.
+         */
+        std::int32_t clip;
+        float speed;
+        std::uint32_t transition_begin;
+        std::uint32_t transition_end;
+    };
+
+    struct CompiledTransition {
+        std::uint32_t destination;
+        float duration;
+        float exit_time;
+        std::uint32_t condition_begin;
+        std::uint32_t condition_end;
+    };
+
+    struct CompiledCondition {
+        std::uint32_t parameter;
+
+        /**
+         * @brief Set of comparison results which pass the condition.
+         *
+         * Bit 0 is less than the threshold, bit 1 equal and bit 2 greater.
+         */
+        std::uint32_t mask;
+        float threshold;
+        bool consume;
+    };
+
+    static constexpr std::uint32_t less_bit = 1u << 0;
+    static constexpr std::uint32_t equal_bit = 1u << 1;
+    static constexpr std::uint32_t greater_bit = 1u << 2;
+
+    static std::uint32_t compare(float value, float threshold) noexcept {
+        const float difference = value - threshold;
+        return static_cast<std::uint32_t>(difference < 0.f) * less_bit
+               | static_cast<std::uint32_t>(difference == 0.f) * equal_bit
+               | static_cast<std::uint32_t>(difference > 0.f) * greater_bit;
+    }
+
+    AnimatorDescription() {}
+
+    int add_parameter(const std::string &name, AnimatorParameterType type, float default_value = 0.f) {
+        parameters_.push_back({name, type, default_value});
+        compiled_ = false;
+        return static_cast<int>(parameters_.size()) - 1;
+    }
+
+    int add_state(const std::string &name, std::shared_ptr<AnimationClip> clip, float speed = 1.f) {
+        states_.push_back({name, std::move(clip), speed});
+        compiled_ = false;
+        return static_cast<int>(states_.size()) - 1;
+    }
+
+    int add_transition(int source, int destination, float duration, float exit_time = -1.f) {
+        assert(0 <= source && source < static_cast<int>(states_.size()));
+        assert(0 <= destination && destination < static_cast<int>(states_.size()));
+        transitions_.push_back({source, destination, duration, exit_time, {}});
+        compiled_ = false;
+        return static_cast<int>(transitions_.size()) - 1;
+    }
+
+    void add_condition(int transition, int parameter, AnimatorConditionMode mode, float threshold = 0.f) {
+        assert(0 <= parameter && parameter < static_cast<int>(parameters_.size()));
+        transitions_.at(transition).conditions.push_back({parameter, mode, threshold});
+        compiled_ = false;
+    }
+
+    void set_default_state(int state) {
+        default_state_ = state;
+        compiled_ = false;
+    }
+
+    int default_state() const noexcept {
+        return default_state_;
+    }
+
+    int find_parameter(const std::string &name) const {
+        auto iter = std::find_if(parameters_.begin(), parameters_.end(),
+                                 [&](const AnimatorParameter &parameter) { return parameter.name == name; });
+        return iter == parameters_.end() ? -1 : static_cast<int>(std::distance(parameters_.begin(), iter));
+    }
+
+    int find_state(const std::string &name) const {
+        auto iter = std::find_if(states_.begin(), states_.end(),
+                                 [&](const AnimatorState &state) { return state.name == name; });
+        return iter == states_.end() ? -1 : static_cast<int>(std::distance(states_.begin(), iter));
+    }
+
+    const std::vector<AnimatorParameter> &parameters() const noexcept {
+        return parameters_;
+    }
+
+    const std::vector<AnimatorState> &states() const noexcept {
+        return states_;
+    }
+
+    const std::vector<AnimatorTransition> &transitions() const noexcept {
+        return transitions_;
+    }
+
+    /**
+     * @brief Builds the flat tables from the states, transitions and conditions.
+     *
+     * Any modification invalidates the tables, so compile() must be called again before playback.
+     */
+    void compile() {
+        clips_.clear();
+        compiled_states_.clear();
+        compiled_transitions_.clear();
+        compiled_conditions_.clear();
+
+        compiled_states_.reserve(states_.size());
+        compiled_transitions_.reserve(transitions_.size());
+
+        for (int state_index = 0; state_index < static_cast<int>(states_.size()); ++state_index) {
+            const auto &state = states_[state_index];
+
+            CompiledState compiled_state;
+            compiled_state.clip = -1;
+            compiled_state.speed = state.speed;
+
+            if (state.clip) {
+                auto iter = std::find(clips_.begin(), clips_.end(), state.clip);
+                if (iter == clips_.end()) iter = clips_.insert(clips_.end(), state.clip);
+                compiled_state.clip = static_cast<std::int32_t>(std::distance(clips_.begin(), iter));
+            }
+
+            // Transitions are grouped by source state, keeping the order they were added in.
+            compiled_state.transition_begin = static_cast<std::uint32_t>(compiled_transitions_.size());
+            for (const auto &transition : transitions_) {
+                if (transition.source != state_index) continue;
+
+                CompiledTransition compiled_transition;
+                compiled_transition.destination = static_cast<std::uint32_t>(transition.destination);
+                compiled_transition.duration = (std::max)(transition.duration, 0.f);
+                compiled_transition.exit_time = transition.exit_time;
+                compiled_transition.condition_begin = static_cast<std::uint32_t>(compiled_conditions_.size());
+
+                for (const auto &condition : transition.conditions) {
+                    compiled_conditions_.push_back(compile_condition(condition));
+                }
+                compiled_transition.condition_end = static_cast<std::uint32_t>(compiled_conditions_.size());
+                compiled_transitions_.push_back(compiled_transition);
+            }
+            compiled_state.transition_end = static_cast<std::uint32_t>(compiled_transitions_.size());
+
+            compiled_states_.push_back(compiled_state);
+        }
+
+        compiled_ = true;
+        ++compiled_version_;
+    }
+
+    bool compiled() const noexcept {
+        return compiled_;
+    }
+
+    /**
+     * @brief Incremented by each compile(), so that bindings to the clips can be refreshed.
+     */
+    std::uint32_t compiled_version() const noexcept {
+        return compiled_version_;
+    }
+
+    /**
+     * @brief The distinct clips referenced by the states.
+     */
+    const std::vector<std::shared_ptr<AnimationClip>> &clips() const noexcept {
+        return clips_;
+    }
+
+    const std::vector<CompiledState> &compiled_states() const noexcept {
+        return compiled_states_;
+    }
+
+    const std::vector<CompiledTransition> &compiled_transitions() const noexcept {
+        return compiled_transitions_;
+    }
+
+    const std::vector<CompiledCondition> &compiled_conditions() const noexcept {
+        return compiled_conditions_;
+    }
+
+private:
+    CompiledCondition compile_condition(const AnimatorCondition &condition) const {
+        CompiledCondition compiled;
+        compiled.parameter = static_cast<std::uint32_t>(condition.parameter);
+        compiled.threshold = condition.threshold;
+        compiled.consume = parameters_[condition.parameter].type == AnimatorParameterType::Trigger;
+
+        switch (condition.mode) {
+        case AnimatorConditionMode::Greater:
+            compiled.mask = greater_bit;
+            break;
+        case AnimatorConditionMode::Less:
+            compiled.mask = less_bit;
+            break;
+        case AnimatorConditionMode::Equals:
+            compiled.mask = equal_bit;
+            break;
+        case AnimatorConditionMode::NotEquals:
+            compiled.mask = less_bit | greater_bit;
+            break;
+        case AnimatorConditionMode::If:
+            compiled.mask = less_bit | greater_bit;
+            compiled.threshold = 0.f;
+            break;
+        case AnimatorConditionMode::IfNot:
+            compiled.mask = equal_bit;
+            compiled.threshold = 0.f;
+            break;
+        }
+        return compiled;
+    }
+
+private:
+    std::vector<AnimatorParameter> parameters_;
+    std::vector<AnimatorState> states_;
+    std::vector<AnimatorTransition> transitions_;
+    int default_state_{0};
 
+    bool compiled_{false};
+    std::uint32_t compiled_version_{0};
+    std::vector<std::shared_ptr<AnimationClip>> clips_;
+    std::vector<CompiledState> compiled_states_;
+    std::vector<CompiledTransition> compiled_transitions_;
+    std::vector<CompiledCondition> compiled_conditions_;
 };
-}   
-}
+} // namespace resources
+} // namespace nodec_animation
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,198 @@
+#ifndef NODEC_ANIMATION__RESOURCES__ASYNC_CLIP_LOADER_HPP_
+#define NODEC_ANIMATION__RESOURCES__ASYNC_CLIP_LOADER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "animation_clip.hpp"
+
+namespace nodec_animation {
+namespace resources {
+
+/**
+ * @brief A clip which is being loaded in the background.
+ *
+ * Checking whether it is ready is a single atomic load, so it may be polled every frame.
+ */
+class ClipRequest {
+public:
+    explicit ClipRequest(const std::string &name)
+        : name_(name) {}
+
+    const std::string &name() const noexcept {
+        return name_;
+    }
+
+    bool ready() const noexcept {
+        return ready_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns the loaded clip, or nullptr if loading failed. Only valid once ready.
+     */
+    const std::shared_ptr<AnimationClip> &clip() const noexcept {
+        return clip_;
+    }
+
+    void fulfill(std::shared_ptr<AnimationClip> clip) {
+        clip_ = std::move(clip);
+        ready_.store(true, std::memory_order_release);
+    }
+
+private:
+    std::string name_;
+    std::shared_ptr<AnimationClip> clip_;
+    std::atomic<bool> ready_{false};
+};
+
+/**
+ * @brief Loads clips on worker threads.
+ *
+ * Requests for the same name share one ClipRequest. The load function is called concurrently
+ * from the workers, so it must be thread-safe.
+ */
+class AsyncClipLoader {
+public:
+    using LoadFunction = std::function<std::shared_ptr<AnimationClip>(const std::string &name)>;
+
+    explicit AsyncClipLoader(LoadFunction load, unsigned thread_count = std::thread::hardware_concurrency())
+        : load_(std::move(load)) {
+        if (thread_count == 0) thread_count = 1;
+        for (unsigned i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~AsyncClipLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        queue_changed_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+
+    AsyncClipLoader(const AsyncClipLoader &) = delete;
+    AsyncClipLoader &operator=(const AsyncClipLoader &) = delete;
+
+    std::shared_ptr<ClipRequest> request(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto &request = requests_[name];
+        if (request) return request;
+
+        request = std::make_shared<ClipRequest>(name);
+        queue_.push_back(request);
+        ++pending_count_;
+        queue_changed_.notify_one();
+        return request;
+    }
+
+    /**
+     * @brief Blocks until every requested clip has been loaded.
+     */
+    void wait_all() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_done_.wait(lock, [&]() { return pending_count_ == 0; });
+    }
+
+    std::size_t pending_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_count_;
+    }
+
+    /**
+     * @brief Forgets the finished requests, so that their names are loaded again when requested.
+     */
+    void clear_finished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto iter = requests_.begin(); iter != requests_.end();) {
+            iter = iter->second->ready() ? requests_.erase(iter) : std::next(iter);
+        }
+    }
+
+private:
+    void work() {
+        while (true) {
+            std::shared_ptr<ClipRequest> request;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                queue_changed_.wait(lock, [&]() { return stopping_ || !queue_.empty(); });
+                if (stopping_ && queue_.empty()) return;
+
+                request = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            std::shared_ptr<AnimationClip> clip;
+            try {
+                clip = load_(request->name());
+            } catch (...) {
+                // A failed load leaves the request with no clip.
+            }
+            request->fulfill(std::move(clip));
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_count_;
+                if (pending_count_ == 0) all_done_.notify_all();
+            }
+        }
+    }
+
+private:
+    LoadFunction load_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_changed_;
+    std::condition_variable all_done_;
+    std::deque<std::shared_ptr<ClipRequest>> queue_;
+    std::unordered_map<std::string, std::shared_ptr<ClipRequest>> requests_;
+    std::size_t pending_count_{0};
+    bool stopping_{false};
+};
+
+namespace impl {
+
+inline AsyncClipLoader *&current_async_clip_loader() {
+    thread_local AsyncClipLoader *loader = nullptr;
+    return loader;
+}
+
+} // namespace impl
+
+/**
+ * @brief Makes the SerializableAnimators loaded by the current thread request their clips from the loader
+ * until it goes out of scope, instead of loading them synchronously.
+ */
+class ScopedAsyncClipLoading {
+public:
+    explicit ScopedAsyncClipLoading(AsyncClipLoader &loader)
+        : previous_(impl::current_async_clip_loader()) {
+        impl::current_async_clip_loader() = &loader;
+    }
+
+    ~ScopedAsyncClipLoading() {
+        impl::current_async_clip_loader() = previous_;
+    }
+
+    ScopedAsyncClipLoading(const ScopedAsyncClipLoading &) = delete;
+    ScopedAsyncClipLoading &operator=(const ScopedAsyncClipLoading &) = delete;
+
+private:
+    AsyncClipLoader *previous_;
+};
+
+} // namespace resources
+} // namespace nodec_animation
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef NODEC_ANIMATION__RESOURCES__CLIP_DATABASE_HPP_
+#define NODEC_ANIMATION__RESOURCES__CLIP_DATABASE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../arena.hpp"
+#include "animation_clip.hpp"
+
+namespace nodec_animation {
+namespace resources {
+
+/**
+ * @brief Identifies a clip in a ClipDatabase.
+ *
+ * A handle stays valid until its clip is removed. Handles of removed clips are never reused.
+ */
+struct ClipHandle {
+    std::uint32_t index{0xffffffffu};
+    std::uint32_t generation{0};
+};
+
+inline bool operator==(const ClipHandle &lhs, const ClipHandle &rhs) noexcept {
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+inline bool operator!=(const ClipHandle &lhs, const ClipHandle &rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+/**
+ * @brief Packs the keyframes of all registered clips into one contiguous buffer.
+ *
+ * The curves of a registered clip share their keyframes with the database. The keyframes of a clip are laid out
+ * in the order of its entity tree, and clips one after another in registration order, so evaluating many clips
+ * walks through memory in one direction instead of jumping between separate allocations.
+ *
+ * Removing clips leaves holes, which are closed by compact(): the live clips are packed again into a single
+ * new block, and the old buffer is freed once no copy of its keyframes is left.
+ *
+ * Curves sharing keyframes, e.g. through a CurveStore or by copying a clip, share the packed keyframes as well,
+ * across all clips registered, so shared keyframes are packed once.
+ *
+ * The clips themselves stay separate objects, so the animators keep referring to them as before.
+ * Streamed clips are not packed, since their keyframes keep changing, and neither are curves short enough
+ * to keep their keyframes inline.
+ */
+class ClipDatabase {
+public:
+    struct Options {
+        /**
+         * @brief The size of the blocks holding the keyframes added between compactions.
+         */
+        std::size_t block_size{MonotonicArena::huge_page_size};
+
+        /**
+         * @brief Backs the buffer with huge pages where the platform supports them.
+         */
+        bool huge_pages{false};
+
+        /**
+         * @brief remove() compacts the buffer once this fraction of its bytes belongs to removed clips.
+         * Zero or less disables the automatic compaction.
+         */
+        float compaction_threshold{0.5f};
+    };
+
+    ClipDatabase()
+        : ClipDatabase(Options()) {}
+
+    explicit ClipDatabase(const Options &options)
+        : options_(options), arena_(make_arena(options.block_size)) {}
+
+    ClipDatabase(const ClipDatabase &) = delete;
+    ClipDatabase &operator=(const ClipDatabase &) = delete;
+
+    /**
+     * @brief Registers the clip and packs its keyframes after those of the clips already registered.
+     */
+    ClipHandle add(std::shared_ptr<AnimationClip> clip) {
+        if (!clip) return ClipHandle();
+
+        std::uint32_t index;
+        if (free_slots_.empty()) {
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        } else {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        }
+
+        // Entries of keyframes freed since, e.g. by curves replaced in registered clips, are dropped
+        // once the map has doubled.
+        if (2 * pruned_size_ < packed_sources_.size()) prune_packed_sources();
+
+        auto &slot = slots_[index];
+        slot.clip = std::move(clip);
+        slot.bytes = pack(*slot.clip, arena_);
+        packed_bytes_ += slot.bytes;
+        live_bytes_ += slot.bytes;
+        ++clip_count_;
+        return {index, slot.generation};
+    }
+
+    /**
+     * @brief Returns the clip, or nullptr if the handle does not refer to a registered clip.
+     */
+    const std::shared_ptr<AnimationClip> &get(ClipHandle handle) const noexcept {
+        static const std::shared_ptr<AnimationClip> none;
+        if (!contains(handle)) return none;
+        return slots_[handle.index].clip;
+    }
+
+    bool contains(ClipHandle handle) const noexcept {
+        return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation
+               && slots_[handle.index].clip;
+    }
+
+    /**
+     * @brief Unregisters the clip. Its keyframes stay alive for as long as the clip is used elsewhere.
+     *
+     * @return false if the handle does not refer to a registered clip.
+     */
+    bool remove(ClipHandle handle) {
+        if (!contains(handle)) return false;
+
+        auto &slot = slots_[handle.index];
+        live_bytes_ -= slot.bytes;
+        slot.clip.reset();
+        slot.bytes = 0;
+        ++slot.generation;
+        free_slots_.push_back(handle.index);
+        --clip_count_;
+
+        // The entries of the keyframes only used by the removed clip have expired now.
+        prune_packed_sources();
+
+        if (options_.compaction_threshold > 0.f
+            && options_.compaction_threshold * static_cast<float>(packed_bytes_)
+                   < static_cast<float>(packed_bytes_ - live_bytes_)) {
+            compact();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Packs the keyframes of the registered clips into a new buffer without holes.
+     *
+     * Curves sharing keyframes before keep sharing them. The hints of bound animation states stay valid,
+     * since the keyframes do not change.
+     */
+    void compact() {
+        const auto block_size = live_bytes_ < options_.block_size ? options_.block_size : live_bytes_;
+        auto arena = make_arena(block_size);
+
+        // Keyframes shared from elsewhere, e.g. a CurveStore, are to lead to the new packed keyframes.
+        // Their packed keyframes are held until then, since the curves let go of them while being packed again.
+        std::vector<std::pair<std::shared_ptr<const KeyframeVector>, std::shared_ptr<const KeyframeVector>>> carried;
+        for (const auto &entry : packed_sources_) {
+            auto source = entry.second.source.lock();
+            auto packed = entry.second.packed.lock();
+            if (source && packed && source != packed) carried.emplace_back(std::move(source), std::move(packed));
+        }
+        packed_sources_.clear();
+
+        packed_bytes_ = 0;
+        for (auto &slot : slots_) {
+            if (!slot.clip) continue;
+            slot.bytes = pack(*slot.clip, arena);
+            packed_bytes_ += slot.bytes;
+        }
+        live_bytes_ = packed_bytes_;
+
+        for (const auto &entry : carried) {
+            auto iter = packed_sources_.find(entry.second.get());
+            if (iter == packed_sources_.end()) continue;
+            packed_sources_[entry.first.get()] = {entry.first, iter->second.packed};
+        }
+
+        pruned_size_ = packed_sources_.size();
+
+        // The old buffer lives on in the keyframes still referenced by copies of the curves.
+        arena_ = std::move(arena);
+    }
+
+    std::size_t clip_count() const noexcept {
+        return clip_count_;
+    }
+
+    /**
+     * @brief Returns the bytes packed for the registered clips.
+     */
+    std::size_t live_bytes() const noexcept {
+        return live_bytes_;
+    }
+
+    /**
+     * @brief Returns the bytes packed into the current buffer, including those of removed clips.
+     */
+    std::size_t packed_bytes() const noexcept {
+        return packed_bytes_;
+    }
+
+    /**
+     * @brief Returns the bytes reserved by the current buffer.
+     */
+    std::size_t reserved_bytes() const noexcept {
+        return arena_->reserved_bytes();
+    }
+
+    std::size_t block_count() const noexcept {
+        return arena_->block_count();
+    }
+
+    /**
+     * @brief Returns the number of shared keyframes the database finds again when packing curves sharing them.
+     */
+    std::size_t shared_keyframes_count() const noexcept {
+        return packed_sources_.size();
+    }
+
+private:
+    using KeyframeVector = AnimationCurve::KeyframeVector;
+
+    /**
+     * @brief The packed copy of keyframes shared by curves. Both are weak, so that an entry neither keeps
+     * keyframes alive nor matches other keyframes allocated at the address of freed ones.
+     */
+    struct PackedSource {
+        std::weak_ptr<const KeyframeVector> source;
+        std::weak_ptr<const KeyframeVector> packed;
+    };
+
+    struct Slot {
+        std::shared_ptr<AnimationClip> clip;
+        std::size_t bytes{0};
+        std::uint32_t generation{0};
+    };
+
+    std::shared_ptr<MonotonicArena> make_arena(std::size_t block_size) const {
+        return std::make_shared<MonotonicArena>(block_size, options_.huge_pages);
+    }
+
+    /**
+     * @brief Drops the entries whose shared or packed keyframes have been freed.
+     */
+    void prune_packed_sources() {
+        for (auto iter = packed_sources_.begin(); iter != packed_sources_.end();) {
+            if (iter->second.source.expired() || iter->second.packed.expired()) {
+                iter = packed_sources_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        pruned_size_ = packed_sources_.size();
+    }
+
+    std::size_t pack(AnimationClip &clip, const std::shared_ptr<MonotonicArena> &arena) {
+        if (clip.stream()) return 0;
+
+        std::size_t bytes = 0;
+        clip.update_curves([&](AnimationCurve &curve) {
+            // Short curves keep their keyframes inline, next to the rest of the clip.
+            const auto keyframes = curve.keyframes();
+            if (keyframes.size() <= AnimationCurve::inline_capacity) return;
+
+            // Only shared keyframes may be found again: those owned by the curve are freed right below.
+            const auto source = curve.shared_keyframes();
+            if (source) {
+                auto iter = packed_sources_.find(source.get());
+                if (iter != packed_sources_.end() && iter->second.source.lock() == source) {
+                    if (auto packed = iter->second.packed.lock()) {
+                        if (packed != source) curve.share_keyframes(std::move(packed));
+                        return;
+                    }
+                }
+            }
+
+            // The vector is placed in the arena right before its keyframes. The deleter keeps the arena alive
+            // for as long as any curve refers to the vector.
+            auto *memory = arena->allocate(sizeof(KeyframeVector), alignof(KeyframeVector));
+            auto *vector = new (memory) KeyframeVector(keyframes.begin(), keyframes.end(),
+                                                       KeyframeVector::allocator_type(arena.get()));
+            std::shared_ptr<const KeyframeVector> shared(vector, [arena](const KeyframeVector *vector) {
+                vector->~KeyframeVector();
+            });
+
+            bytes += sizeof(KeyframeVector) + keyframes.size() * sizeof(Keyframe);
+            if (source) packed_sources_[source.get()] = {source, shared};
+            packed_sources_[shared.get()] = {shared, shared};
+            curve.share_keyframes(std::move(shared));
+        });
+        return bytes;
+    }
+
+private:
+    Options options_;
+    std::shared_ptr<MonotonicArena> arena_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+    std::size_t clip_count_{0};
+    std::size_t packed_bytes_{0};
+    std::size_t live_bytes_{0};
+
+    // By the address of the shared keyframes, including the packed keyframes themselves.
+    std::unordered_map<const KeyframeVector *, PackedSource> packed_sources_;
+    std::size_t pruned_size_{0};
+};
+
+} // namespace resources
+} // namespace nodec_animation
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef NODEC_ANIMATION__RESOURCES__CURVE_STORE_HPP_
+#define NODEC_ANIMATION__RESOURCES__CURVE_STORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "animation_clip.hpp"
+
+namespace nodec_animation {
+namespace resources {
+
+/**
+ * @brief Memory used by the keyframes of the curves sharing the keyframes of a CurveStore.
+ */
+struct CurveStoreReport {
+    /**
+     * @brief The curves using keyframes of the store.
+     */
+    std::size_t curve_count{0};
+
+    /**
+     * @brief The distinct keyframe arrays held by the store.
+     */
+    std::size_t unique_curve_count{0};
+
+    /**
+     * @brief The bytes the keyframes would take if every curve had its own copy.
+     */
+    std::size_t total_keyframe_bytes{0};
+
+    /**
+     * @brief The bytes the keyframes actually take.
+     */
+    std::size_t unique_keyframe_bytes{0};
+};
+
+/**
+ * @brief Shares identical keyframes between the curves of all clips passed to it.
+ *
+ * Keyframe arrays are found by a hash of their contents and compared byte by byte.
+ * The store only keeps weak references: an array is freed with the last curve using it,
+ * so the reference count of an array is the number of curves sharing it.
+ *
+ * Curves which only differ in their wrap mode share their keyframes as well.
+ * The store may be used from several loading threads at once.
+ */
+class CurveStore {
+public:
+    using KeyframeVector = AnimationCurve::KeyframeVector;
+
+    void deduplicate(AnimationCurve &curve) {
+        // Short curves keep their keyframes inline, which is smaller than sharing them.
+        const auto keyframes = curve.keyframes();
+        if (keyframes.size() <= AnimationCurve::inline_capacity) return;
+
+        const auto hash = hash_keyframes(keyframes);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &bucket = entries_[hash];
+        for (auto iter = bucket.begin(); iter != bucket.end();) {
+            auto shared = iter->lock();
+            if (!shared) {
+                iter = bucket.erase(iter);
+                continue;
+            }
+            if (shared == curve.shared_keyframes()) return;
+
+            if (equal(*shared, keyframes)) {
+                curve.share_keyframes(std::move(shared));
+                return;
+            }
+            ++iter;
+        }
+
+        // Kept on the heap, since the clips sharing it may come from different arenas.
+        auto shared = std::make_shared<const KeyframeVector>(keyframes.begin(), keyframes.end());
+        bucket.push_back(shared);
+        curve.share_keyframes(std::move(shared));
+    }
+
+    void deduplicate(AnimationClip &clip) {
+        clip.update_curves([&](AnimationCurve &curve) { deduplicate(curve); });
+    }
+
+    /**
+     * @brief Forgets the keyframe arrays which are no longer used by any curve.
+     */
+    void collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto bucket = entries_.begin(); bucket != entries_.end();) {
+            auto &entries = bucket->second;
+            for (auto iter = entries.begin(); iter != entries.end();) {
+                iter = iter->expired() ? entries.erase(iter) : std::next(iter);
+            }
+            bucket = entries.empty() ? entries_.erase(bucket) : std::next(bucket);
+        }
+    }
+
+    CurveStoreReport report() const {
+        CurveStoreReport report;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &bucket : entries_) {
+            for (const auto &entry : bucket.second) {
+                auto shared = entry.lock();
+                if (!shared) continue;
+
+                // Not counting the reference taken just now.
+                const auto users = static_cast<std::size_t>(shared.use_count() - 1);
+                const auto bytes = shared->size() * sizeof(Keyframe);
+
+                report.curve_count += users;
+                report.unique_curve_count += 1;
+                report.total_keyframe_bytes += users * bytes;
+                report.unique_keyframe_bytes += bytes;
+            }
+        }
+        return report;
+    }
+
+private:
+    static std::uint64_t hash_keyframes(KeyframeSpan keyframes) noexcept {
+        // FNV-1a over the bytes of the keyframes.
+        std::uint64_t hash = 14695981039346656037ull;
+        const auto *bytes = reinterpret_cast<const unsigned char *>(keyframes.data());
+        const auto size = keyframes.size() * sizeof(Keyframe);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static bool equal(const KeyframeVector &lhs, KeyframeSpan rhs) noexcept {
+        return lhs.size() == rhs.size()
+               && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(Keyframe)) == 0;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::uint64_t, std::vector<std::weak_ptr<const KeyframeVector>>> entries_;
+};
+
+namespace impl {
+
+inline CurveStore *&current_curve_store() {
+    thread_local CurveStore *store = nullptr;
+    return store;
+}
+
+} // namespace impl
+
+/**
+ * @brief Makes the clips loaded by the current thread share their curves through the store
+ * until it goes out of scope.
+ */
+class ScopedCurveDeduplication {
+public:
+    explicit ScopedCurveDeduplication(CurveStore &store)
+        : previous_(impl::current_curve_store()) {
+        impl::current_curve_store() = &store;
+    }
+
+    ~ScopedCurveDeduplication() {
+        impl::current_curve_store() = previous_;
+    }
+
+    ScopedCurveDeduplication(const ScopedCurveDeduplication &) = delete;
+    ScopedCurveDeduplication &operator=(const ScopedCurveDeduplication &) = delete;
+
+private:
+    CurveStore *previous_;
+};
+
+} // namespace resources
+} // namespace nodec_animation
+
+#endif
@@ -1,32 +1,248 @@
 #ifndef NODEC_ANIMATION__SERIALIZATION__ANIMATION_CURVE_HPP_
 #define NODEC_ANIMATION__SERIALIZATION__ANIMATION_CURVE_HPP_
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include <cereal/cereal.hpp>
 #include <cereal/types/vector.hpp>
 
 #include <nodec_animation/animation_curve.hpp>
 
+#include "impl/optional_nvp.hpp"
 #include "keyframe.hpp"
 
 namespace nodec_animation {
+namespace serialization {
+
+enum class CurveEncoding {
+    /**
+     * @brief An array of {"time", "value"} objects.
+     */
+    Keyframes,
+
+    /**
+     * @brief Parallel "times" and "values" arrays.
+     */
+    Arrays,
+
+    /**
+     * @brief A "sample_rate", the "frames" of the keys as deltas from the previous key and the "values".
+     *
+     * Curves whose key times are not on the frames of the sample rate are saved as Arrays.
+     */
+    SampledArrays,
+};
+
+struct CurveSaveOptions {
+    CurveEncoding encoding{CurveEncoding::Keyframes};
+
+    /**
+     * @brief Frames per second used by CurveEncoding::SampledArrays.
+     */
+    float sample_rate{60.f};
+};
+
+namespace impl {
+
+inline CurveSaveOptions &curve_save_options() {
+    thread_local CurveSaveOptions options;
+    return options;
+}
+
+} // namespace impl
+
+/**
+ * @brief Sets the encoding of the curves saved by the current thread until it goes out of scope.
+ *
+ * The compact encodings are only used by archives with named nodes, such as JSON and XML.
+ * Binary archives always use CurveEncoding::Keyframes, which is already compact there.
+ */
+class ScopedCurveSaveOptions {
+public:
+    explicit ScopedCurveSaveOptions(const CurveSaveOptions &options)
+        : previous_(impl::curve_save_options()) {
+        impl::curve_save_options() = options;
+    }
+
+    ~ScopedCurveSaveOptions() {
+        impl::curve_save_options() = previous_;
+    }
+
+    ScopedCurveSaveOptions(const ScopedCurveSaveOptions &) = delete;
+    ScopedCurveSaveOptions &operator=(const ScopedCurveSaveOptions &) = delete;
+
+private:
+    CurveSaveOptions previous_;
+};
+
+namespace impl {
+
+// Each array is written and read as a plain array of numbers,
+// filling the keyframes directly instead of going through a temporary per key.
+
+struct ConstKeyframeTimes {
+    KeyframeSpan keyframes;
+
+    template<class Archive>
+    void save(Archive &archive) const {
+        archive(cereal::make_size_tag(static_cast<cereal::size_type>(keyframes.size())));
+        for (const auto &keyframe : keyframes) archive(keyframe.time);
+    }
+};
+
+struct ConstKeyframeValues {
+    KeyframeSpan keyframes;
+
+    template<class Archive>
+    void save(Archive &archive) const {
+        archive(cereal::make_size_tag(static_cast<cereal::size_type>(keyframes.size())));
+        for (const auto &keyframe : keyframes) archive(keyframe.value);
+    }
+};
+
+struct ConstKeyframeFrames {
+    const std::vector<std::int32_t> &frames;
+
+    template<class Archive>
+    void save(Archive &archive) const {
+        archive(cereal::make_size_tag(static_cast<cereal::size_type>(frames.size())));
+        for (auto frame : frames) archive(frame);
+    }
+};
+
+struct KeyframeTimes {
+    std::vector<Keyframe> &keyframes;
+
+    template<class Archive>
+    void load(Archive &archive) {
+        cereal::size_type size;
+        archive(cereal::make_size_tag(size));
+        keyframes.resize(static_cast<std::size_t>(size));
+        for (auto &keyframe : keyframes) archive(keyframe.time);
+    }
+};
+
+struct KeyframeValues {
+    std::vector<Keyframe> &keyframes;
+
+    template<class Archive>
+    void load(Archive &archive) {
+        cereal::size_type size;
+        archive(cereal::make_size_tag(size));
+        if (size != keyframes.size()) throw cereal::Exception("The times and values of a curve differ in size.");
+        for (auto &keyframe : keyframes) archive(keyframe.value);
+    }
+};
+
+struct KeyframeFrames {
+    std::vector<Keyframe> &keyframes;
+    float sample_rate;
+
+    template<class Archive>
+    void load(Archive &archive) {
+        cereal::size_type size;
+        archive(cereal::make_size_tag(size));
+        keyframes.resize(static_cast<std::size_t>(size));
+
+        std::int64_t frame = 0;
+        for (auto &keyframe : keyframes) {
+            std::int32_t delta;
+            archive(delta);
+            frame += delta;
+            keyframe.time = static_cast<float>(static_cast<double>(frame) / sample_rate);
+        }
+    }
+};
+
+/**
+ * @brief Converts the key times to frame deltas, or returns false if a time is not on a frame.
+ */
+inline bool to_frame_deltas(KeyframeSpan keyframes, float sample_rate,
+                            std::vector<std::int32_t> &deltas) {
+    if (!(sample_rate > 0.f)) return false;
+
+    deltas.clear();
+    deltas.reserve(keyframes.size());
+
+    std::int64_t previous = 0;
+    for (const auto &keyframe : keyframes) {
+        const double frame = std::round(static_cast<double>(keyframe.time) * sample_rate);
+        if (std::abs(frame) > 2147483647.0) return false;
+        if (static_cast<float>(frame / sample_rate) != keyframe.time) return false;
+
+        const auto current = static_cast<std::int64_t>(frame);
+        deltas.push_back(static_cast<std::int32_t>(current - previous));
+        previous = current;
+    }
+    return true;
+}
+
+template<class Archive>
+void save_curve_arrays(Archive &archive, const AnimationCurve &curve, const CurveSaveOptions &options) {
+    if (options.encoding == CurveEncoding::SampledArrays) {
+        std::vector<std::int32_t> deltas;
+        if (to_frame_deltas(curve.keyframes(), options.sample_rate, deltas)) {
+            archive(cereal::make_nvp("sample_rate", options.sample_rate));
+            archive(cereal::make_nvp("frames", ConstKeyframeFrames{deltas}));
+            archive(cereal::make_nvp("values", ConstKeyframeValues{curve.keyframes()}));
+            return;
+        }
+    }
+    archive(cereal::make_nvp("times", ConstKeyframeTimes{curve.keyframes()}));
+    archive(cereal::make_nvp("values", ConstKeyframeValues{curve.keyframes()}));
+}
+
+} // namespace impl
+} // namespace serialization
 
 template<class Archive>
 void save(Archive &archive, const AnimationCurve &curve) {
+    using namespace serialization;
+
     archive(cereal::make_nvp("wrap_mode", curve.wrap_mode()));
+
+    const auto &options = serialization::impl::curve_save_options();
+    if (nodec_animation::impl::has_node_name<Archive>::value && options.encoding != CurveEncoding::Keyframes) {
+        serialization::impl::save_curve_arrays(archive, curve, options);
+        return;
+    }
     archive(cereal::make_nvp("keyframes", curve.keyframes()));
 }
 
+/**
+ * @brief Loads a curve in any of the encodings of serialization::CurveEncoding.
+ *
+ * The encoding is recognized by the name of the node following "wrap_mode".
+ */
 template<class Archive>
 void load(Archive &archive, AnimationCurve &curve) {
-    std::vector<Keyframe> keyframes;
-    archive(cereal::make_nvp("keyframes", keyframes));
-    curve.set_keyframes(std::move(keyframes));
-
     WrapMode wrap_mode;
     archive(cereal::make_nvp("wrap_mode", wrap_mode));
     curve.set_wrap_mode(wrap_mode);
+
+    std::vector<Keyframe> keyframes;
+
+    const char *next = nodec_animation::impl::next_node_name(archive);
+    if (next && std::strcmp(next, "sample_rate") == 0) {
+        float sample_rate;
+        archive(cereal::make_nvp("sample_rate", sample_rate));
+        if (!(sample_rate > 0.f)) throw cereal::Exception("The sample rate of a curve must be positive.");
+
+        archive(cereal::make_nvp("frames", serialization::impl::KeyframeFrames{keyframes, sample_rate}));
+        archive(cereal::make_nvp("values", serialization::impl::KeyframeValues{keyframes}));
+    } else if (next && std::strcmp(next, "times") == 0) {
+        archive(cereal::make_nvp("times", serialization::impl::KeyframeTimes{keyframes}));
+        archive(cereal::make_nvp("values", serialization::impl::KeyframeValues{keyframes}));
+    } else {
+        archive(cereal::make_nvp("keyframes", keyframes));
+    }
+
+    curve.set_keyframes(std::move(keyframes));
 }
 
 } // namespace nodec_animation
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,20 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__ANIMATION_EVENT_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__ANIMATION_EVENT_HPP_
+
+#include <cereal/cereal.hpp>
+
+#include <nodec_animation/animation_event.hpp>
+
+namespace nodec_animation {
+
+template<class Archive>
+void serialize(Archive &archive, AnimationEvent &event) {
+    archive(cereal::make_nvp("time", event.time));
+    archive(cereal::make_nvp("id", event.id));
+    archive(cereal::make_nvp("int_payload", event.int_payload));
+    archive(cereal::make_nvp("float_payload", event.float_payload));
+}
+
+} // namespace nodec_animation
+
+#endif
@@ -0,0 +1,506 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__BINARY_CLIP_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__BINARY_CLIP_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nodec/type_info.hpp>
+
+#include "../arena.hpp"
+#include "../resources/animation_clip.hpp"
+#include "../resources/curve_store.hpp"
+#include "mapped_file.hpp"
+
+namespace nodec_animation {
+namespace serialization {
+
+// The binary clip format is made to be memory-mapped and read in place.
+//
+// All tables are arrays of fixed-size records addressed by byte offsets from the beginning of the file,
+// and every reference between records is an index or a string offset. The layout is:
+//
+//   BinaryClipHeader
+//   BinaryClipEntity[entity_count]        breadth-first, so the children of an entity are contiguous
+//   BinaryClipComponent[component_count]  grouped by entity
+//   BinaryClipProperty[property_count]    grouped by component, sorted by name
+//   BinaryClipEvent[event_count]          sorted by time
+//   Keyframe[keyframe_count]              16-byte aligned, grouped by property
+//   char strings[string_size]             null-terminated entity names, component type names and property names
+//
+// Multi-byte values are stored little-endian. Both the writer and the view use the native values as they are,
+// so the format is only supported on little-endian targets.
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#    error "Binary clips are read and written with native values and require a little-endian target."
+#endif
+
+constexpr std::uint32_t binary_clip_version = 1;
+constexpr std::uint32_t binary_clip_keyframe_alignment = 16;
+
+struct BinaryClipHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t file_size;
+    std::uint32_t entity_count;
+    std::uint32_t entity_offset;
+    std::uint32_t component_count;
+    std::uint32_t component_offset;
+    std::uint32_t property_count;
+    std::uint32_t property_offset;
+    std::uint32_t event_count;
+    std::uint32_t event_offset;
+    std::uint32_t keyframe_count;
+    std::uint32_t keyframe_offset;
+    std::uint32_t string_offset;
+    std::uint32_t string_size;
+    std::uint32_t reserved;
+};
+
+struct BinaryClipEntity {
+    std::uint32_t name;
+    std::uint32_t child_begin;
+    std::uint32_t child_end;
+    std::uint32_t component_begin;
+    std::uint32_t component_end;
+};
+
+struct BinaryClipComponent {
+    std::uint32_t type_name;
+    std::uint32_t property_begin;
+    std::uint32_t property_end;
+};
+
+struct BinaryClipProperty {
+    std::uint32_t name;
+    std::uint32_t wrap_mode;
+    std::uint32_t keyframe_begin;
+    std::uint32_t keyframe_end;
+};
+
+struct BinaryClipEvent {
+    float time;
+    std::uint32_t id;
+    std::int32_t int_payload;
+    float float_payload;
+};
+
+static_assert(sizeof(BinaryClipHeader) == 64, "The header must not be padded.");
+static_assert(sizeof(Keyframe) == 8 && std::is_trivially_copyable<Keyframe>::value,
+              "Keyframes are read in place from the file.");
+
+/**
+ * @brief Maps component types to the names stored in binary clips.
+ *
+ * The names must be stable between the writing and the loading program.
+ */
+class BinaryClipTypeTable {
+public:
+    template<class Component>
+    void register_type(const std::string &name) {
+        register_type(nodec::type_id<Component>(), name);
+    }
+
+    void register_type(const nodec::type_info &type_info, const std::string &name) {
+        names_.emplace(type_info, name);
+        types_.emplace(name, type_info);
+    }
+
+    const std::string *find_name(const nodec::type_info &type_info) const {
+        auto iter = names_.find(type_info);
+        return iter == names_.end() ? nullptr : &iter->second;
+    }
+
+    const nodec::type_info *find_type(const std::string &name) const {
+        auto iter = types_.find(name);
+        return iter == types_.end() ? nullptr : &iter->second;
+    }
+
+private:
+    std::unordered_map<nodec::type_info, std::string> names_;
+    std::unordered_map<std::string, nodec::type_info> types_;
+};
+
+/**
+ * @brief Read-only view of a binary clip in memory, typically a MappedFile.
+ *
+ * Nothing is copied: all accessors point into the viewed bytes, which must outlive the view.
+ * The structure is validated once at construction, so the accessors do no checks of their own.
+ */
+class BinaryClipView {
+public:
+    BinaryClipView() {}
+
+    BinaryClipView(const void *data, std::size_t size)
+        : data_(static_cast<const char *>(data)), size_(size) {
+        valid_ = validate();
+    }
+
+    bool valid() const noexcept {
+        return valid_;
+    }
+
+    const BinaryClipHeader &header() const noexcept {
+        return *reinterpret_cast<const BinaryClipHeader *>(data_);
+    }
+
+    const BinaryClipEntity *entities() const noexcept {
+        return table<BinaryClipEntity>(header().entity_offset);
+    }
+
+    const BinaryClipComponent *components() const noexcept {
+        return table<BinaryClipComponent>(header().component_offset);
+    }
+
+    const BinaryClipProperty *properties() const noexcept {
+        return table<BinaryClipProperty>(header().property_offset);
+    }
+
+    const BinaryClipEvent *events() const noexcept {
+        return table<BinaryClipEvent>(header().event_offset);
+    }
+
+    const Keyframe *keyframes() const noexcept {
+        return table<Keyframe>(header().keyframe_offset);
+    }
+
+    const char *string(std::uint32_t offset) const noexcept {
+        return data_ + header().string_offset + offset;
+    }
+
+    /**
+     * @brief Finds the child of the entity with the name by binary search, or returns -1.
+     */
+    int find_child(std::uint32_t entity, const char *name) const {
+        const auto &record = entities()[entity];
+        auto begin = entities() + record.child_begin;
+        auto end = entities() + record.child_end;
+        auto iter = std::lower_bound(begin, end, name, [&](const BinaryClipEntity &child, const char *name) {
+            return std::strcmp(string(child.name), name) < 0;
+        });
+        if (iter == end || std::strcmp(string(iter->name), name) != 0) return -1;
+        return static_cast<int>(iter - entities());
+    }
+
+private:
+    template<class T>
+    const T *table(std::uint32_t offset) const noexcept {
+        return reinterpret_cast<const T *>(data_ + offset);
+    }
+
+    template<class T>
+    bool check_table(std::uint32_t offset, std::uint32_t count, std::size_t alignment = alignof(T)) const {
+        if (offset % alignment != 0) return false;
+        if (size_ < offset) return false;
+        return count <= (size_ - offset) / sizeof(T);
+    }
+
+    bool check_string(std::uint32_t offset) const {
+        const auto &header = this->header();
+        if (header.string_size <= offset) return false;
+        return std::memchr(data_ + header.string_offset + offset, '\0', header.string_size - offset) != nullptr;
+    }
+
+    bool validate() const {
+        if (!data_ || size_ < sizeof(BinaryClipHeader)) return false;
+        if (reinterpret_cast<std::uintptr_t>(data_) % binary_clip_keyframe_alignment != 0) return false;
+
+        const auto &header = this->header();
+        if (std::memcmp(header.magic, "NACL", 4) != 0) return false;
+        if (header.version != binary_clip_version) return false;
+        if (header.file_size != size_) return false;
+
+        if (!check_table<BinaryClipEntity>(header.entity_offset, header.entity_count)) return false;
+        if (!check_table<BinaryClipComponent>(header.component_offset, header.component_count)) return false;
+        if (!check_table<BinaryClipProperty>(header.property_offset, header.property_count)) return false;
+        if (!check_table<BinaryClipEvent>(header.event_offset, header.event_count)) return false;
+        if (!check_table<Keyframe>(header.keyframe_offset, header.keyframe_count, binary_clip_keyframe_alignment)) return false;
+        if (!check_table<char>(header.string_offset, header.string_size)) return false;
+        if (header.entity_count == 0) return false;
+
+        // Children always come after their parent, so walking the tree terminates.
+        for (std::uint32_t i = 0; i < header.entity_count; ++i) {
+            const auto &entity = entities()[i];
+            if (!check_string(entity.name)) return false;
+            if (entity.child_begin > entity.child_end || header.entity_count < entity.child_end) return false;
+            if (entity.child_begin != entity.child_end && entity.child_begin <= i) return false;
+            if (entity.component_begin > entity.component_end || header.component_count < entity.component_end) return false;
+        }
+        for (std::uint32_t i = 0; i < header.component_count; ++i) {
+            const auto &component = components()[i];
+            if (!check_string(component.type_name)) return false;
+            if (component.property_begin > component.property_end || header.property_count < component.property_end) return false;
+        }
+        for (std::uint32_t i = 0; i < header.property_count; ++i) {
+            const auto &property = properties()[i];
+            if (!check_string(property.name)) return false;
+            if (property.wrap_mode > static_cast<std::uint32_t>(WrapMode::Loop)) return false;
+            if (property.keyframe_begin > property.keyframe_end || header.keyframe_count < property.keyframe_end) return false;
+        }
+        return true;
+    }
+
+private:
+    const char *data_{nullptr};
+    std::size_t size_{0};
+    bool valid_{false};
+};
+
+namespace impl {
+
+class BinaryClipWriter {
+public:
+    BinaryClipWriter(const BinaryClipTypeTable &types)
+        : types_(types) {}
+
+    bool write(const resources::AnimationClip &clip, std::vector<char> &out) {
+        intern("");
+
+        // Breadth-first, with the children of each entity in name order.
+        std::vector<std::pair<const resources::AnimatedEntity *, std::uint32_t>> queue;
+        queue.emplace_back(&clip.root_entity(), 0);
+        entities_.push_back({0, 0, 0, 0, 0});
+
+        for (std::size_t index = 0; index < queue.size(); ++index) {
+            const auto &entity = *queue[index].first;
+
+            entities_[index].component_begin = static_cast<std::uint32_t>(components_.size());
+            if (!write_components(entity)) return false;
+            entities_[index].component_end = static_cast<std::uint32_t>(components_.size());
+
+            entities_[index].child_begin = static_cast<std::uint32_t>(entities_.size());
+            for (const auto &child : entity.children) {
+                queue.emplace_back(&child.second, 0);
+                entities_.push_back({intern(child.first), 0, 0, 0, 0});
+            }
+            entities_[index].child_end = static_cast<std::uint32_t>(entities_.size());
+        }
+
+        for (const auto &event : clip.events()) {
+            events_.push_back({event.time, event.id, event.int_payload, event.float_payload});
+        }
+
+        BinaryClipHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "NACL", 4);
+        header.version = binary_clip_version;
+
+        std::size_t offset = sizeof(BinaryClipHeader);
+        auto place = [&](std::size_t size, std::size_t alignment) {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            const auto placed = offset;
+            offset += size;
+            return static_cast<std::uint32_t>(placed);
+        };
+
+        header.entity_count = static_cast<std::uint32_t>(entities_.size());
+        header.entity_offset = place(entities_.size() * sizeof(BinaryClipEntity), alignof(BinaryClipEntity));
+        header.component_count = static_cast<std::uint32_t>(components_.size());
+        header.component_offset = place(components_.size() * sizeof(BinaryClipComponent), alignof(BinaryClipComponent));
+        header.property_count = static_cast<std::uint32_t>(properties_.size());
+        header.property_offset = place(properties_.size() * sizeof(BinaryClipProperty), alignof(BinaryClipProperty));
+        header.event_count = static_cast<std::uint32_t>(events_.size());
+        header.event_offset = place(events_.size() * sizeof(BinaryClipEvent), alignof(BinaryClipEvent));
+        header.keyframe_count = static_cast<std::uint32_t>(keyframes_.size());
+        header.keyframe_offset = place(keyframes_.size() * sizeof(Keyframe), binary_clip_keyframe_alignment);
+        header.string_size = static_cast<std::uint32_t>(strings_.size());
+        header.string_offset = place(strings_.size(), 1);
+        header.file_size = static_cast<std::uint32_t>(place(0, binary_clip_keyframe_alignment));
+
+        out.assign(header.file_size, '\0');
+        auto copy = [&](std::uint32_t offset, const void *data, std::size_t size) {
+            if (size > 0) std::memcpy(out.data() + offset, data, size);
+        };
+        copy(0, &header, sizeof(header));
+        copy(header.entity_offset, entities_.data(), entities_.size() * sizeof(BinaryClipEntity));
+        copy(header.component_offset, components_.data(), components_.size() * sizeof(BinaryClipComponent));
+        copy(header.property_offset, properties_.data(), properties_.size() * sizeof(BinaryClipProperty));
+        copy(header.event_offset, events_.data(), events_.size() * sizeof(BinaryClipEvent));
+        copy(header.keyframe_offset, keyframes_.data(), keyframes_.size() * sizeof(Keyframe));
+        copy(header.string_offset, strings_.data(), strings_.size());
+        return true;
+    }
+
+private:
+    std::uint32_t intern(const std::string &value) {
+        auto iter = string_offsets_.find(value);
+        if (iter != string_offsets_.end()) return iter->second;
+
+        const auto offset = static_cast<std::uint32_t>(strings_.size());
+        strings_.insert(strings_.end(), value.begin(), value.end());
+        strings_.push_back('\0');
+        string_offsets_.emplace(value, offset);
+        return offset;
+    }
+
+    bool write_components(const resources::AnimatedEntity &entity) {
+        // Sorted by type name, so that the output does not depend on the hash order.
+        std::vector<std::pair<const std::string *, const resources::AnimatedComponent *>> sorted;
+        for (const auto &component : entity.components) {
+            const auto *name = types_.find_name(component.first);
+            if (!name) return false;
+            sorted.emplace_back(name, &component.second);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto &lhs, const auto &rhs) { return *lhs.first < *rhs.first; });
+
+        for (const auto &component : sorted) {
+            BinaryClipComponent record;
+            record.type_name = intern(*component.first);
+            record.property_begin = static_cast<std::uint32_t>(properties_.size());
+
+            std::vector<const std::pair<const std::string, resources::AnimatedProperty> *> properties;
+            for (const auto &property : component.second->properties) properties.push_back(&property);
+            std::sort(properties.begin(), properties.end(), [](const auto *lhs, const auto *rhs) { return lhs->first < rhs->first; });
+
+            for (const auto *property : properties) {
+                const auto &keyframes = property->second.curve.keyframes();
+
+                BinaryClipProperty property_record;
+                property_record.name = intern(property->first);
+                property_record.wrap_mode = static_cast<std::uint32_t>(property->second.curve.wrap_mode());
+                property_record.keyframe_begin = static_cast<std::uint32_t>(keyframes_.size());
+                keyframes_.insert(keyframes_.end(), keyframes.begin(), keyframes.end());
+                property_record.keyframe_end = static_cast<std::uint32_t>(keyframes_.size());
+                properties_.push_back(property_record);
+            }
+
+            record.property_end = static_cast<std::uint32_t>(properties_.size());
+            components_.push_back(record);
+        }
+        return true;
+    }
+
+private:
+    const BinaryClipTypeTable &types_;
+    std::vector<BinaryClipEntity> entities_;
+    std::vector<BinaryClipComponent> components_;
+    std::vector<BinaryClipProperty> properties_;
+    std::vector<BinaryClipEvent> events_;
+    std::vector<Keyframe> keyframes_;
+    std::vector<char> strings_;
+    std::unordered_map<std::string, std::uint32_t> string_offsets_;
+};
+
+inline void load_binary_entity(const BinaryClipView &view, std::uint32_t index, const BinaryClipTypeTable &types,
+                               const std::shared_ptr<const void> &owner, resources::AnimatedEntity &entity) {
+    const auto &record = view.entities()[index];
+
+    for (auto component_index = record.component_begin; component_index < record.component_end; ++component_index) {
+        const auto &component = view.components()[component_index];
+
+        // Like the cereal loader, components of unknown types are skipped.
+        const auto *type_info = types.find_type(view.string(component.type_name));
+        if (!type_info) continue;
+
+        auto &properties = entity.components[*type_info].properties;
+        for (auto property_index = component.property_begin; property_index < component.property_end; ++property_index) {
+            const auto &property = view.properties()[property_index];
+
+            auto &curve = properties[view.string(property.name)].curve;
+            const auto *keyframes = view.keyframes() + property.keyframe_begin;
+            const auto size = static_cast<std::size_t>(property.keyframe_end - property.keyframe_begin);
+            if (owner && AnimationCurve::inline_capacity < size) {
+                // Read in place. Short curves keep their keyframes inline, next to the rest of the clip.
+                curve.reference_keyframes(std::shared_ptr<const Keyframe>(owner, keyframes), size);
+            } else {
+                curve.set_keyframes(keyframes, keyframes + size);
+            }
+            curve.set_wrap_mode(static_cast<WrapMode>(property.wrap_mode));
+        }
+    }
+
+    for (auto child_index = record.child_begin; child_index < record.child_end; ++child_index) {
+        auto &child = entity.children[view.string(view.entities()[child_index].name)];
+        load_binary_entity(view, child_index, types, owner, child);
+    }
+}
+
+} // namespace impl
+
+/**
+ * @brief Converts the clip, for example one loaded from JSON with the cereal serializer, into the binary format.
+ *
+ * @return false if a component type of the clip is not in the type table.
+ */
+inline bool write_binary_clip(const resources::AnimationClip &clip, const BinaryClipTypeTable &types,
+                              std::vector<char> &out) {
+    impl::BinaryClipWriter writer(types);
+    return writer.write(clip, out);
+}
+
+inline bool write_binary_clip(const resources::AnimationClip &clip, const BinaryClipTypeTable &types,
+                              const std::string &path) {
+    std::vector<char> data;
+    if (!write_binary_clip(clip, types, data)) return false;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Creates a clip from a binary clip.
+ *
+ * The entity tree is built from the tables. Given the owner of the viewed bytes, the curves read their keyframes
+ * in place and keep the owner alive; without it, the keyframes of each curve are copied with one block copy,
+ * so the viewed bytes need not outlive the clip. Nothing is parsed from text, but the tree and its names are
+ * still allocated. With an arena, the tree and any copied keyframes are placed in it.
+ *
+ * @param owner Keeps the viewed bytes alive, e.g. the MappedFile they are in.
+ * @return nullptr if the view is not valid.
+ */
+inline std::shared_ptr<resources::AnimationClip> load_binary_clip(const BinaryClipView &view,
+                                                                  const BinaryClipTypeTable &types,
+                                                                  std::shared_ptr<MonotonicArena> arena = nullptr,
+                                                                  const std::shared_ptr<const void> &owner = nullptr) {
+    if (!view.valid()) return nullptr;
+
+    auto clip = arena ? std::make_shared<resources::AnimationClip>(arena)
+                      : std::make_shared<resources::AnimationClip>();
+
+    // Built with the allocator of the clip, so that it is moved in without copying.
+    resources::AnimatedEntity root_entity(resources::AnimatedEntity::allocator_type(arena.get()));
+    impl::load_binary_entity(view, 0, types, owner, root_entity);
+    clip->set_root_entity(std::move(root_entity));
+
+    std::vector<AnimationEvent> events;
+    events.reserve(view.header().event_count);
+    for (std::uint32_t i = 0; i < view.header().event_count; ++i) {
+        const auto &event = view.events()[i];
+        events.push_back({event.time, event.id, event.int_payload, event.float_payload});
+    }
+    clip->set_events(std::move(events));
+
+    if (auto *store = resources::impl::current_curve_store()) store->deduplicate(*clip);
+
+    return clip;
+}
+
+/**
+ * @brief Maps the file and creates a clip reading its keyframes in place.
+ *
+ * The file stays mapped for as long as a curve of the clip, or a copy of one, refers to it.
+ *
+ * @return nullptr if the file could not be mapped or is not a valid binary clip.
+ */
+inline std::shared_ptr<resources::AnimationClip> load_binary_clip(const std::string &path,
+                                                                  const BinaryClipTypeTable &types,
+                                                                  std::shared_ptr<MonotonicArena> arena = nullptr) {
+    auto file = std::make_shared<MappedFile>(path);
+    if (!file->is_open()) return nullptr;
+    return load_binary_clip(BinaryClipView(file->data(), file->size()), types, std::move(arena), file);
+}
+
+} // namespace serialization
+} // namespace nodec_animation
+
+#endif
@@ -1,11 +1,15 @@
 #ifndef NODEC_ANIMATION__SERIALIZATION__COMPONENTS__ANIMATOR_HPP_
 #define NODEC_ANIMATION__SERIALIZATION__COMPONENTS__ANIMATOR_HPP_
 
+#include <cstdint>
+
 #include <nodec_scene_serialization/serializable_component.hpp>
 #include <nodec_scene_serialization/archive_context.hpp>
 
 #include <nodec_animation/components/animator.hpp>
 
+#include "../impl/optional_nvp.hpp"
+
 namespace nodec_animation {
 namespace components {
 
@@ -14,37 +18,76 @@ struct SerializableAnimator : nodec_scene_serialization::BaseSerializableCompone
         : BaseSerializableComponent(this) {
     }
     SerializableAnimator(const Animator &animator)
-        : BaseSerializableComponent(this), clip(animator.clip) {
+        : BaseSerializableComponent(this), clip(animator.clip), speed(animator.speed), clip_request(animator.clip_request) {
     }
 
     operator Animator() const noexcept {
         Animator value;
         value.clip = clip;
+        value.speed = speed;
+        value.clip_request = clip_request;
         return value;
     }
 
     std::shared_ptr<resources::AnimationClip> clip;
+    float speed{1.f};
+    std::shared_ptr<resources::ClipRequest> clip_request;
 
-    template<class Archive>
+    // Binary archives store the animator with a class version, and the speed from version 1 on.
+    // Text archives find the speed by name, so text scenes saved before it was added keep loading.
+
+    template<class Archive, cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
     void save(Archive &archive) const {
+        save_fields(archive);
+    }
+
+    template<class Archive, cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+    void save(Archive &archive, std::uint32_t) const {
+        save_fields(archive);
+    }
+
+    template<class Archive, cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+    void load(Archive &archive) {
+        load_clip(archive);
+        nodec_animation::impl::load_optional_nvp(archive, "speed", speed);
+    }
+
+    template<class Archive, cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+    void load(Archive &archive, std::uint32_t version) {
+        load_clip(archive);
+        if (version >= 1) archive(cereal::make_nvp("speed", speed));
+    }
+
+private:
+    template<class Archive>
+    void save_fields(Archive &archive) const {
         using namespace nodec_scene_serialization;
         ArchiveContext &context = cereal::get_user_data<ArchiveContext>(archive);
 
-        archive(cereal::make_nvp("clip", context.resource_registry().lookup_name<resources::AnimationClip>(clip).first));
+        if (clip_request) {
+            archive(cereal::make_nvp("clip", clip_request->name()));
+        } else {
+            archive(cereal::make_nvp("clip", context.resource_registry().lookup_name<resources::AnimationClip>(clip).first));
+        }
+        archive(cereal::make_nvp("speed", speed));
     }
 
     template<class Archive>
-    void load(Archive &archive) {
+    void load_clip(Archive &archive) {
         using namespace nodec_scene_serialization;
         using namespace nodec::resource_management;
 
         auto &context = cereal::get_user_data<ArchiveContext>(archive);
 
-        {
-            std::string name;
-            archive(cereal::make_nvp("clip", name));
-            clip = context.resource_registry().get_resource_direct<resources::AnimationClip>(name);
+        std::string name;
+        archive(cereal::make_nvp("clip", name));
+
+        // Within a ScopedAsyncClipLoading, the clip is only requested and the start is deferred until it is loaded.
+        if (auto *loader = resources::impl::current_async_clip_loader()) {
+            clip_request = loader->request(name);
+            return;
         }
+        clip = context.resource_registry().get_resource_direct<resources::AnimationClip>(name);
     }
 };
 
@@ -87,4 +130,6 @@ NODEC_SCENE_REGISTER_SERIALIZABLE_COMPONENT(nodec_animation::components::Seriali
 NODEC_SCENE_REGISTER_SERIALIZABLE_COMPONENT(nodec_animation::components::SerializableAnimatorStart)
 NODEC_SCENE_REGISTER_SERIALIZABLE_COMPONENT(nodec_animation::components::SerializableAnimatorStop)
 
+CEREAL_CLASS_VERSION(nodec_animation::components::SerializableAnimator, 1)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__IMPL__OPTIONAL_NVP_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__IMPL__OPTIONAL_NVP_HPP_
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include <cereal/cereal.hpp>
+
+namespace nodec_animation {
+namespace impl {
+
+template<class Archive, class = void>
+struct has_node_name : std::false_type {};
+
+template<class Archive>
+struct has_node_name<Archive, decltype(void(std::declval<Archive &>().getNodeName()))> : std::true_type {};
+
+template<class Archive>
+const char *next_node_name(Archive &archive, std::true_type) {
+    return archive.getNodeName();
+}
+
+template<class Archive>
+const char *next_node_name(Archive &, std::false_type) {
+    return nullptr;
+}
+
+/**
+ * @brief Returns the name of the next node if the archive is a text archive which knows it,
+ * otherwise nullptr.
+ */
+template<class Archive>
+const char *next_node_name(Archive &archive) {
+    return next_node_name(archive, has_node_name<Archive>{});
+}
+
+/**
+ * @brief Loads the named value only if it is the next node of the archive.
+ *
+ * Archives without node names (e.g. binary archives) always contain the value,
+ * so it is loaded unconditionally.
+ *
+ * @return true if the value was loaded.
+ */
+template<class Archive, class T>
+bool load_optional_nvp(Archive &archive, const char *name, T &value) {
+    if (has_node_name<Archive>::value) {
+        const char *next = next_node_name(archive);
+        if (next == nullptr || std::strcmp(next, name) != 0) return false;
+    }
+    archive(cereal::make_nvp(name, value));
+    return true;
+}
+
+} // namespace impl
+} // namespace nodec_animation
+
+#endif
@@ -13,6 +13,15 @@ void serialize(Archive &archive, Keyframe &keyframe) {
     archive(cereal::make_nvp("value", keyframe.value));
 }
 
+/**
+ * @brief Saves the keyframes like a std::vector<Keyframe>, so that they are loaded into one.
+ */
+template<class Archive>
+void save(Archive &archive, const KeyframeSpan &keyframes) {
+    archive(cereal::make_size_tag(static_cast<cereal::size_type>(keyframes.size())));
+    for (const auto &keyframe : keyframes) archive(keyframe);
+}
+
 } // namespace nodec_animation
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__MAPPED_FILE_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace nodec_animation {
+namespace serialization {
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * The pages are loaded by the operating system when they are first touched.
+ */
+class MappedFile {
+public:
+    MappedFile() {}
+
+    explicit MappedFile(const std::string &path) {
+        open(path);
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this == &other) return *this;
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        return *this;
+    }
+
+    /**
+     * @return false if the file could not be opened or is empty.
+     */
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return false;
+
+        data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!data_) return false;
+
+        size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+        const int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) return false;
+
+        struct stat status;
+        if (::fstat(file, &status) != 0 || status.st_size <= 0) {
+            ::close(file);
+            return false;
+        }
+
+        void *data = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (data == MAP_FAILED) return false;
+
+        data_ = data;
+        size_ = static_cast<std::size_t>(status.st_size);
+#endif
+        return true;
+    }
+
+    void close() noexcept {
+        if (!data_) return;
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        ::munmap(data_, size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_open() const noexcept {
+        return data_ != nullptr;
+    }
+
+    const void *data() const noexcept {
+        return data_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+private:
+    void *data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace serialization
+} // namespace nodec_animation
+
+#endif
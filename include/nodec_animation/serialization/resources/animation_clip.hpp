@@ -1,17 +1,22 @@
 #ifndef NODEC_ANIMATION__SERIALIZATION__RESOURCES__ANIMATION_CLIP_HPP_
 #define NODEC_ANIMATION__SERIALIZATION__RESOURCES__ANIMATION_CLIP_HPP_
 
+#include <cstdint>
 #include <memory>
 
 #include <cereal/cereal.hpp>
 #include <cereal/types/memory.hpp>
 #include <cereal/types/unordered_map.hpp>
+#include <cereal/types/vector.hpp>
 #include <nodec_scene_serialization/archive_context.hpp>
 #include <nodec_scene_serialization/serializable_component.hpp>
 
 #include <nodec_animation/resources/animation_clip.hpp>
+#include <nodec_animation/resources/curve_store.hpp>
 
 #include "../animation_curve.hpp"
+#include "../animation_event.hpp"
+#include "../impl/optional_nvp.hpp"
 
 namespace nodec_animation {
 namespace resources {
@@ -29,12 +34,12 @@ void serialize(Archive &archive, AnimatedComponent &component) {
 struct SerializableAnimatedComponentForSave {
     SerializableAnimatedComponentForSave(
         std::unique_ptr<nodec_scene_serialization::BaseSerializableComponent> &&placeholder,
-        const std::unordered_map<std::string, AnimatedProperty> &ref_properties)
+        const AnimatedComponent::PropertyMap &ref_properties)
         : placeholder(std::move(placeholder)),
           ref_properties(ref_properties) {}
 
     std::unique_ptr<nodec_scene_serialization::BaseSerializableComponent> placeholder;
-    const std::unordered_map<std::string, AnimatedProperty> &ref_properties;
+    const AnimatedComponent::PropertyMap &ref_properties;
 
     template<class Archive>
     void serialize(Archive &archive) {
@@ -45,7 +50,7 @@ struct SerializableAnimatedComponentForSave {
 
 struct SerializableAnimatedComponentForLoad {
     std::unique_ptr<nodec_scene_serialization::BaseSerializableComponent> placeholder;
-    std::unordered_map<std::string, AnimatedProperty> properties;
+    AnimatedComponent::PropertyMap properties;
 
     template<class Archive>
     void serialize(Archive &archive) {
@@ -91,19 +96,53 @@ void load(Archive &archive, AnimatedEntity &entity) {
     archive(cereal::make_nvp("children", entity.children));
 }
 
-template<class Archive>
+// Binary archives store the clip with a class version, and the events from version 1 on.
+// Text archives find the events by name instead, so text clips saved before event tracks
+// were introduced, which have no version, keep loading.
+
+template<class Archive, cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
 void save(Archive &archive, const AnimationClip &clip) {
     archive(cereal::make_nvp("root_entity", clip.root_entity()));
+    archive(cereal::make_nvp("events", clip.events()));
 }
 
-template<class Archive>
+template<class Archive, cereal::traits::EnableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
 void load(Archive &archive, AnimationClip &clip) {
     AnimatedEntity root_entity;
     archive(cereal::make_nvp("root_entity", root_entity));
     clip.set_root_entity(std::move(root_entity));
+
+    // Clips saved before event tracks were introduced have no events.
+    std::vector<AnimationEvent> events;
+    nodec_animation::impl::load_optional_nvp(archive, "events", events);
+    clip.set_events(std::move(events));
+
+    if (auto *store = resources::impl::current_curve_store()) store->deduplicate(clip);
+}
+
+template<class Archive, cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+void save(Archive &archive, const AnimationClip &clip, std::uint32_t) {
+    archive(cereal::make_nvp("root_entity", clip.root_entity()));
+    archive(cereal::make_nvp("events", clip.events()));
+}
+
+template<class Archive, cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value> = cereal::traits::sfinae>
+void load(Archive &archive, AnimationClip &clip, std::uint32_t version) {
+    AnimatedEntity root_entity;
+    archive(cereal::make_nvp("root_entity", root_entity));
+    clip.set_root_entity(std::move(root_entity));
+
+    // Version 0 clips have no event track.
+    std::vector<AnimationEvent> events;
+    if (version >= 1) archive(cereal::make_nvp("events", events));
+    clip.set_events(std::move(events));
+
+    if (auto *store = resources::impl::current_curve_store()) store->deduplicate(clip);
 }
 
 } // namespace resources
 } // namespace nodec_animation
 
+CEREAL_CLASS_VERSION(nodec_animation::resources::AnimationClip, 1)
+
 #endif
\ No newline at end of file
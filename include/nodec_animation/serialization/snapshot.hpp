@@ -0,0 +1,233 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__SNAPSHOT_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__SNAPSHOT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace nodec_animation {
+namespace serialization {
+
+// Snapshots of the runtime state of an AnimatorSystem, written by AnimatorSystem::save_snapshot().
+//
+// A snapshot is a flat buffer of fixed-size records, in the order of the animators and controllers in the registry:
+//
+//   SnapshotHeader
+//   per animator:
+//     SnapshotAnimator
+//     SnapshotAnimatedData[animated_entity_count]  in bind order
+//     std::int32_t hints[hint_count]               the curve hints of the animated entities in bind order
+//   per controller:
+//     SnapshotController
+//     float parameters[parameter_count]
+//     std::int32_t hints[hint_count]               the curve hints of the bindings in order
+//
+// Entities are stored by their id, and nothing else refers to the clips: a snapshot only restores into the bindings
+// it was taken from. Values are stored in native byte order, for rollback and quick saves within one build.
+
+constexpr std::uint32_t snapshot_version = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t size;
+    std::uint32_t animator_count;
+    std::uint32_t controller_count;
+    std::uint32_t reserved;
+};
+
+struct SnapshotAnimator {
+    std::uint32_t entity;
+    std::uint32_t sleeping;
+    std::int64_t ticks;
+    float time;
+    float speed;
+    float event_time;
+    std::uint32_t event_cursor;
+    std::uint32_t animated_entity_count;
+    std::uint32_t hint_count;
+};
+
+struct SnapshotAnimatedData {
+    std::int64_t ticks;
+    float time;
+    float speed;
+    std::uint32_t sleeping;
+    std::uint32_t reserved;
+};
+
+struct SnapshotController {
+    std::uint32_t entity;
+    std::int32_t current_state;
+    std::int64_t current_ticks;
+    float current_time;
+    std::int32_t next_state;
+    std::int64_t next_ticks;
+    float next_time;
+    float transition_elapsed;
+    float transition_duration;
+    std::uint32_t parameter_count;
+    std::uint32_t hint_count;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 24, "The header must not be padded.");
+static_assert(sizeof(SnapshotAnimator) == 40, "The animator record must not be padded.");
+static_assert(sizeof(SnapshotAnimatedData) == 24, "The animated data record must not be padded.");
+static_assert(sizeof(SnapshotController) == 56, "The controller record must not be padded.");
+
+template<class T>
+void append_snapshot(std::vector<char> &buffer, const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Only plain values are written to snapshots.");
+    const auto *bytes = reinterpret_cast<const char *>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * @brief Reads the records of a snapshot one after another, checking that they stay within its bytes.
+ */
+class SnapshotReader {
+public:
+    SnapshotReader(const char *data, std::size_t size)
+        : data_(data), size_(size) {}
+
+    template<class T>
+    bool read(T &value) noexcept {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values are read from snapshots.");
+        if (size_ - position_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + position_, sizeof(T));
+        position_ += sizeof(T);
+        return true;
+    }
+
+    bool at_end() const noexcept {
+        return position_ == size_;
+    }
+
+private:
+    const char *data_;
+    std::size_t size_;
+    std::size_t position_{0};
+};
+
+// A delta holds a snapshot as the difference to a base snapshot, usually that of the previous frame:
+//
+//   SnapshotDeltaHeader
+//   repeated until the snapshot is complete:
+//     varint unchanged   bytes copied from the base at the same offset
+//     varint changed     followed by that many bytes of the snapshot
+
+struct SnapshotDeltaHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t base_size;
+    std::uint32_t size;
+};
+
+namespace impl {
+
+inline void append_varint(std::vector<char> &buffer, std::size_t value) {
+    while (0x80 <= value) {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+inline bool read_varint(const char *data, std::size_t size, std::size_t &position, std::size_t &value) noexcept {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (size <= position) return false;
+        const auto byte = static_cast<unsigned char>(data[position++]);
+        value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace impl
+
+/**
+ * @brief Encodes the snapshot as the difference to the base snapshot, replacing the contents of delta.
+ *
+ * Unchanged bytes are stored as the length of their run only, so the delta of a frame in which most animators
+ * just advanced their time takes about the bytes of the times.
+ */
+inline void encode_snapshot_delta(const std::vector<char> &base, const std::vector<char> &snapshot,
+                                  std::vector<char> &delta) {
+    // Shorter runs of unchanged bytes are cheaper to repeat than to skip.
+    constexpr std::size_t min_unchanged_run = 3;
+
+    const auto size = snapshot.size();
+    auto unchanged = [&](std::size_t i) { return i < base.size() && base[i] == snapshot[i]; };
+
+    delta.clear();
+    append_snapshot(delta, SnapshotDeltaHeader{{'N', 'A', 'S', 'D'}, snapshot_version,
+                                               static_cast<std::uint32_t>(base.size()),
+                                               static_cast<std::uint32_t>(size)});
+
+    std::size_t i = 0;
+    while (i < size) {
+        const auto copy_begin = i;
+        while (i < size && unchanged(i)) ++i;
+
+        std::size_t changed = 0;
+        while (i + changed < size) {
+            std::size_t run = 0;
+            while (run < min_unchanged_run && i + changed + run < size && unchanged(i + changed + run)) ++run;
+            if (run == min_unchanged_run || i + changed + run == size) break;
+            changed += run + 1;
+        }
+
+        impl::append_varint(delta, i - copy_begin);
+        impl::append_varint(delta, changed);
+        delta.insert(delta.end(), snapshot.data() + i, snapshot.data() + i + changed);
+        i += changed;
+    }
+}
+
+/**
+ * @brief Rebuilds a snapshot from the base it was encoded against and the delta.
+ *
+ * The snapshot must be another buffer than the base.
+ *
+ * @return false if the delta is invalid or was encoded against a base of another size.
+ */
+inline bool decode_snapshot_delta(const std::vector<char> &base, const char *delta, std::size_t delta_size,
+                                  std::vector<char> &snapshot) {
+    SnapshotDeltaHeader header;
+    if (delta_size < sizeof(header)) return false;
+    std::memcpy(&header, delta, sizeof(header));
+    if (std::memcmp(header.magic, "NASD", 4) != 0 || header.version != snapshot_version) return false;
+    if (header.base_size != base.size()) return false;
+
+    snapshot.resize(header.size);
+
+    std::size_t position = sizeof(header);
+    std::size_t offset = 0;
+    while (offset < snapshot.size()) {
+        std::size_t unchanged;
+        std::size_t changed;
+        if (!impl::read_varint(delta, delta_size, position, unchanged)) return false;
+        if (!impl::read_varint(delta, delta_size, position, changed)) return false;
+
+        if (base.size() - (std::min)(offset, base.size()) < unchanged
+            || snapshot.size() - offset < unchanged) return false;
+        if (unchanged > 0) std::memcpy(snapshot.data() + offset, base.data() + offset, unchanged);
+        offset += unchanged;
+
+        if (snapshot.size() - offset < changed || delta_size - position < changed) return false;
+        if (changed > 0) std::memcpy(snapshot.data() + offset, delta + position, changed);
+        offset += changed;
+        position += changed;
+    }
+    return position == delta_size;
+}
+
+} // namespace serialization
+} // namespace nodec_animation
+
+#endif
@@ -0,0 +1,528 @@
+#ifndef NODEC_ANIMATION__SERIALIZATION__STREAMING_CLIP_HPP_
+#define NODEC_ANIMATION__SERIALIZATION__STREAMING_CLIP_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nodec/type_info.hpp>
+
+#include "../resources/animation_clip.hpp"
+#include "binary_clip.hpp"
+
+namespace nodec_animation {
+namespace serialization {
+
+// The streaming clip format splits the curves of a long clip into chunks of a fixed duration,
+// so that only the chunks around the playback time need to be in memory. The layout is:
+//
+//   StreamingClipHeader
+//   StreamingClipTrack[track_count]   one per curve, sorted by path, component type name and property name
+//   BinaryClipEvent[event_count]      sorted by time
+//   StreamingClipChunk[chunk_count]   in time order
+//   char strings[string_size]         null-terminated paths, component type names and property names
+//   chunk data                        per chunk, std::uint32_t keyframe_counts[track_count] and then the keyframes
+//
+// Chunk i covers the times [i * chunk_duration, (i + 1) * chunk_duration). For each curve it holds the keys inside it
+// together with the last key at or before its start and the first key at or after its end.
+// A chunk is therefore self-contained: evaluating it anywhere inside its time range gives the same value
+// as evaluating the whole curve, and no neighbouring chunk is needed at the boundaries.
+//
+// Multi-byte values are stored little-endian.
+
+constexpr std::uint32_t streaming_clip_version = 1;
+
+struct StreamingClipHeader {
+    char magic[4];
+    std::uint32_t version;
+    float chunk_duration;
+    float duration;
+    std::uint32_t chunk_count;
+    std::uint32_t chunk_offset;
+    std::uint32_t track_count;
+    std::uint32_t track_offset;
+    std::uint32_t event_count;
+    std::uint32_t event_offset;
+    std::uint32_t string_offset;
+    std::uint32_t string_size;
+};
+
+struct StreamingClipTrack {
+    std::uint32_t path;
+    std::uint32_t type_name;
+    std::uint32_t property_name;
+};
+
+struct StreamingClipChunk {
+    std::uint64_t offset;
+    std::uint32_t keyframe_count;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(StreamingClipHeader) == 48, "The header must not be padded.");
+static_assert(sizeof(StreamingClipChunk) == 16, "The chunk records must not be padded.");
+
+namespace impl {
+
+struct StreamingClipTrackSource {
+    std::string path;
+    const std::string *type_name;
+    std::string property_name;
+    const AnimationCurve *curve;
+};
+
+inline bool collect_streaming_tracks(const resources::AnimatedEntity &entity, const std::string &path,
+                                     const BinaryClipTypeTable &types, std::vector<StreamingClipTrackSource> &tracks) {
+    for (const auto &component : entity.components) {
+        const auto *type_name = types.find_name(component.first);
+        if (!type_name) return false;
+
+        for (const auto &property : component.second.properties) {
+            tracks.push_back({path, type_name, property.first, &property.second.curve});
+        }
+    }
+    for (const auto &child : entity.children) {
+        const auto child_path = path.empty() ? child.first : path + "/" + child.first;
+        if (!collect_streaming_tracks(child.second, child_path, types, tracks)) return false;
+    }
+    return true;
+}
+
+} // namespace impl
+
+/**
+ * @brief Converts the clip into the streaming format, cutting its curves into chunks of the given duration.
+ *
+ * @return false if a component type of the clip is not in the type table, a curve loops,
+ * the chunk duration is not positive or the file could not be written.
+ */
+inline bool write_streaming_clip(const resources::AnimationClip &clip, const BinaryClipTypeTable &types,
+                                 float chunk_duration, const std::string &path) {
+    if (!(chunk_duration > 0.f)) return false;
+
+    std::vector<impl::StreamingClipTrackSource> tracks;
+    if (!impl::collect_streaming_tracks(clip.root_entity(), "", types, tracks)) return false;
+
+    for (const auto &track : tracks) {
+        // A looping curve repeats with its own period, which does not fit into the chunks of the clip.
+        if (track.curve->wrap_mode() == WrapMode::Loop) return false;
+    }
+
+    // Sorted, so that the output does not depend on the hash order.
+    std::sort(tracks.begin(), tracks.end(), [](const auto &lhs, const auto &rhs) {
+        if (lhs.path != rhs.path) return lhs.path < rhs.path;
+        if (*lhs.type_name != *rhs.type_name) return *lhs.type_name < *rhs.type_name;
+        return lhs.property_name < rhs.property_name;
+    });
+
+    std::vector<char> strings;
+    auto intern = [&](const std::string &value) {
+        const auto offset = static_cast<std::uint32_t>(strings.size());
+        strings.insert(strings.end(), value.begin(), value.end());
+        strings.push_back('\0');
+        return offset;
+    };
+
+    intern("");
+
+    std::vector<StreamingClipTrack> track_records;
+    for (const auto &track : tracks) {
+        track_records.push_back({intern(track.path), intern(*track.type_name), intern(track.property_name)});
+    }
+
+    std::vector<BinaryClipEvent> events;
+    for (const auto &event : clip.events()) {
+        events.push_back({event.time, event.id, event.int_payload, event.float_payload});
+    }
+
+    const auto chunk_count = static_cast<std::uint32_t>(
+        (std::max)(1.0, std::ceil(static_cast<double>(clip.duration()) / chunk_duration)));
+
+    StreamingClipHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "NACS", 4);
+    header.version = streaming_clip_version;
+    header.chunk_duration = chunk_duration;
+    header.duration = clip.duration();
+
+    std::size_t offset = sizeof(StreamingClipHeader);
+    auto place = [&](std::size_t size, std::size_t alignment) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        const auto placed = offset;
+        offset += size;
+        return static_cast<std::uint32_t>(placed);
+    };
+
+    header.track_count = static_cast<std::uint32_t>(track_records.size());
+    header.track_offset = place(track_records.size() * sizeof(StreamingClipTrack), alignof(StreamingClipTrack));
+    header.event_count = static_cast<std::uint32_t>(events.size());
+    header.event_offset = place(events.size() * sizeof(BinaryClipEvent), alignof(BinaryClipEvent));
+    header.chunk_count = chunk_count;
+    header.chunk_offset = place(chunk_count * sizeof(StreamingClipChunk), alignof(StreamingClipChunk));
+    header.string_size = static_cast<std::uint32_t>(strings.size());
+    header.string_offset = place(strings.size(), 1);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    auto write = [&](std::uint64_t at, const void *data, std::size_t size) {
+        out.seekp(static_cast<std::streamoff>(at));
+        if (size > 0) out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+
+    // The chunks are written one after another, so that the whole clip is never duplicated in memory.
+    std::vector<StreamingClipChunk> chunks(chunk_count);
+    std::vector<std::uint32_t> keyframe_counts(tracks.size());
+    std::vector<Keyframe> keyframes;
+    std::uint64_t chunk_data_offset = offset;
+
+    for (std::uint32_t chunk = 0; chunk < chunk_count; ++chunk) {
+        Keyframe begin, end;
+        begin.time = static_cast<float>(static_cast<double>(chunk) * chunk_duration);
+        end.time = static_cast<float>(static_cast<double>(chunk + 1) * chunk_duration);
+
+        keyframes.clear();
+        for (std::size_t i = 0; i < tracks.size(); ++i) {
+            const auto &curve_keyframes = tracks[i].curve->keyframes();
+            if (curve_keyframes.empty()) {
+                keyframe_counts[i] = 0;
+                continue;
+            }
+
+            // From the last key at or before the begin up to the first key at or after the end.
+            auto first = std::upper_bound(curve_keyframes.begin(), curve_keyframes.end(), begin);
+            if (first != curve_keyframes.begin()) --first;
+            auto last = std::lower_bound(curve_keyframes.begin(), curve_keyframes.end(), end);
+            if (last != curve_keyframes.end()) ++last;
+
+            keyframes.insert(keyframes.end(), first, last);
+            keyframe_counts[i] = static_cast<std::uint32_t>(std::distance(first, last));
+        }
+
+        chunks[chunk].offset = chunk_data_offset;
+        chunks[chunk].keyframe_count = static_cast<std::uint32_t>(keyframes.size());
+        chunks[chunk].reserved = 0;
+
+        write(chunk_data_offset, keyframe_counts.data(), keyframe_counts.size() * sizeof(std::uint32_t));
+        write(chunk_data_offset + keyframe_counts.size() * sizeof(std::uint32_t),
+              keyframes.data(), keyframes.size() * sizeof(Keyframe));
+        chunk_data_offset += keyframe_counts.size() * sizeof(std::uint32_t) + keyframes.size() * sizeof(Keyframe);
+    }
+
+    write(0, &header, sizeof(header));
+    write(header.track_offset, track_records.data(), track_records.size() * sizeof(StreamingClipTrack));
+    write(header.event_offset, events.data(), events.size() * sizeof(BinaryClipEvent));
+    write(header.chunk_offset, chunks.data(), chunks.size() * sizeof(StreamingClipChunk));
+    write(header.string_offset, strings.data(), strings.size());
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Keeps the curves of a clip filled with the chunk of a streaming clip file around the playback time.
+ *
+ * Only two chunks are in memory: the one in the curves and the next one in playback direction,
+ * which is read ahead on a background thread. Memory therefore stays bounded by the largest chunk,
+ * regardless of the length of the clip. If playback jumps to a chunk which has not been read ahead,
+ * it is read synchronously.
+ *
+ * There is a single sliding window per clip, so a streamed clip should only be played at one time at once.
+ */
+class StreamingClip : public resources::ClipStream {
+public:
+    StreamingClip(std::ifstream &&file, const StreamingClipHeader &header, std::vector<StreamingClipChunk> &&chunks,
+                  std::vector<AnimationCurve *> &&curves)
+        : file_(std::move(file)),
+          chunk_duration_(header.chunk_duration),
+          chunks_(std::move(chunks)),
+          curves_(std::move(curves)),
+          worker_([this]() { work(); }) {
+    }
+
+    ~StreamingClip() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        worker_.join();
+    }
+
+    StreamingClip(const StreamingClip &) = delete;
+    StreamingClip &operator=(const StreamingClip &) = delete;
+
+    void prepare(float time) override {
+        const int needed = chunk_index(time);
+        const int direction = time < previous_time_ ? -1 : 1;
+        previous_time_ = time;
+
+        if (needed != current_.index) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                // The worker may be reading the needed chunk right now, which is quicker than reading it again.
+                changed_.wait(lock, [&]() { return !loading_; });
+
+                if (prefetched_.index == needed) {
+                    std::swap(current_, prefetched_);
+                    prefetched_index_ = prefetched_.index;
+                    ++prefetch_hits_;
+                } else {
+                    read_chunk(needed, current_);
+                    ++synchronous_reads_;
+                }
+            }
+            fill_curves();
+        }
+
+        const int next = needed + direction;
+        if (0 <= next && next < static_cast<int>(chunks_.size())) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (prefetched_index_ != next && requested_ != next) {
+                requested_ = next;
+                changed_.notify_all();
+            }
+        }
+    }
+
+    /**
+     * @brief Blocks until the chunk requested by the last prepare() has been read ahead,
+     * e.g. behind a loading screen after a seek.
+     */
+    void wait_for_prefetch() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&]() { return requested_ < 0 && !loading_; });
+    }
+
+    /**
+     * @brief Returns the index of the chunk in the curves, or -1 before the first prepare().
+     */
+    int resident_chunk() const noexcept {
+        return current_.index;
+    }
+
+    /**
+     * @brief Returns the keyframes held by the curves and the read-ahead buffer.
+     */
+    std::size_t resident_keyframe_count() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&]() { return !loading_; });
+        return current_.keyframes.size() + prefetched_.keyframes.size();
+    }
+
+    std::size_t chunk_count() const noexcept {
+        return chunks_.size();
+    }
+
+    /**
+     * @brief Returns how often the chunk needed by prepare() had already been read ahead.
+     */
+    std::size_t prefetch_hits() const noexcept {
+        return prefetch_hits_;
+    }
+
+    /**
+     * @brief Returns how often prepare() had to read the chunk it needed itself.
+     */
+    std::size_t synchronous_reads() const noexcept {
+        return synchronous_reads_;
+    }
+
+private:
+    struct Chunk {
+        int index{-1};
+        std::vector<std::uint32_t> keyframe_counts;
+        std::vector<Keyframe> keyframes;
+    };
+
+    int chunk_index(float time) const noexcept {
+        // Computed like the chunk times of the writer, so that the chunk always covers the time.
+        const auto index = static_cast<long long>(std::floor(static_cast<double>(time) / chunk_duration_));
+        const auto last = static_cast<long long>(chunks_.size()) - 1;
+        return static_cast<int>(index < 0 ? 0 : (last < index ? last : index));
+    }
+
+    /**
+     * @brief Reads the chunk into the buffer. Only called with exclusive access to the file.
+     *
+     * A chunk which cannot be read leaves the curves empty.
+     */
+    void read_chunk(int index, Chunk &chunk) {
+        const auto &record = chunks_[index];
+        chunk.index = index;
+        chunk.keyframe_counts.resize(curves_.size());
+        chunk.keyframes.resize(record.keyframe_count);
+
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(record.offset));
+        file_.read(reinterpret_cast<char *>(chunk.keyframe_counts.data()),
+                   static_cast<std::streamsize>(chunk.keyframe_counts.size() * sizeof(std::uint32_t)));
+        file_.read(reinterpret_cast<char *>(chunk.keyframes.data()),
+                   static_cast<std::streamsize>(chunk.keyframes.size() * sizeof(Keyframe)));
+
+        std::uint64_t total = 0;
+        for (auto count : chunk.keyframe_counts) total += count;
+
+        if (!file_ || total != record.keyframe_count) {
+            std::fill(chunk.keyframe_counts.begin(), chunk.keyframe_counts.end(), 0u);
+            chunk.keyframes.clear();
+        }
+    }
+
+    void fill_curves() {
+        const Keyframe *keyframes = current_.keyframes.data();
+        for (std::size_t i = 0; i < curves_.size(); ++i) {
+            const auto count = current_.keyframe_counts[i];
+            // The hints of the bound animation states stay in range of the new keyframes or fall back to a search.
+            if (curves_[i]) curves_[i]->set_keyframes(keyframes, keyframes + count);
+            keyframes += count;
+        }
+    }
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            changed_.wait(lock, [&]() { return stopping_ || requested_ >= 0; });
+            if (stopping_) return;
+
+            const int index = requested_;
+            requested_ = -1;
+            prefetched_index_ = index;
+            loading_ = true;
+            lock.unlock();
+
+            // The buffer is only touched by prepare() while nothing is being loaded into it.
+            read_chunk(index, prefetched_);
+
+            lock.lock();
+            loading_ = false;
+            changed_.notify_all();
+        }
+    }
+
+private:
+    std::ifstream file_;
+    float chunk_duration_;
+    std::vector<StreamingClipChunk> chunks_;
+    std::vector<AnimationCurve *> curves_;
+
+    Chunk current_;
+    Chunk prefetched_;
+    float previous_time_{0.f};
+    std::size_t prefetch_hits_{0};
+    std::size_t synchronous_reads_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    int requested_{-1};
+    int prefetched_index_{-1};
+    bool loading_{false};
+    bool stopping_{false};
+
+    // Started last, once everything it uses has been constructed.
+    std::thread worker_;
+};
+
+/**
+ * @brief Opens a streaming clip file.
+ *
+ * The returned clip has the curves and events of the file, and its curves are filled by a StreamingClip,
+ * available through stream(). The file stays open for as long as the clip exists.
+ *
+ * @return nullptr if the file could not be opened or is not a valid streaming clip.
+ */
+inline std::shared_ptr<resources::AnimationClip> open_streaming_clip(const std::string &path,
+                                                                     const BinaryClipTypeTable &types) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return nullptr;
+
+    file.seekg(0, std::ios::end);
+    const auto file_size = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+
+    StreamingClipHeader header;
+    if (file_size < sizeof(header)) return nullptr;
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    if (!file || std::memcmp(header.magic, "NACS", 4) != 0 || header.version != streaming_clip_version) return nullptr;
+    if (!(header.chunk_duration > 0.f) || header.chunk_count == 0) return nullptr;
+
+    auto read_table = [&](std::uint32_t offset, std::size_t size, void *out) {
+        if (file_size < static_cast<std::uint64_t>(offset) + size) return false;
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(static_cast<char *>(out), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    };
+
+    std::vector<StreamingClipTrack> tracks(header.track_count);
+    std::vector<BinaryClipEvent> event_records(header.event_count);
+    std::vector<StreamingClipChunk> chunks(header.chunk_count);
+    std::vector<char> strings(header.string_size);
+
+    if (!read_table(header.track_offset, tracks.size() * sizeof(StreamingClipTrack), tracks.data())
+        || !read_table(header.event_offset, event_records.size() * sizeof(BinaryClipEvent), event_records.data())
+        || !read_table(header.chunk_offset, chunks.size() * sizeof(StreamingClipChunk), chunks.data())
+        || !read_table(header.string_offset, strings.size(), strings.data())) {
+        return nullptr;
+    }
+    if (strings.empty() || strings.back() != '\0') return nullptr;
+
+    for (const auto &chunk : chunks) {
+        const auto size = static_cast<std::uint64_t>(header.track_count) * sizeof(std::uint32_t)
+                          + static_cast<std::uint64_t>(chunk.keyframe_count) * sizeof(Keyframe);
+        if (file_size < chunk.offset || file_size - chunk.offset < size) return nullptr;
+    }
+
+    auto string = [&](std::uint32_t offset) -> const char * {
+        return offset < strings.size() ? strings.data() + offset : nullptr;
+    };
+
+    // The streamed keyframes keep replacing each other, which an arena would never give back.
+    auto clip = std::make_shared<resources::AnimationClip>();
+
+    for (const auto &track : tracks) {
+        const char *path = string(track.path);
+        const char *type_name = string(track.type_name);
+        const char *property_name = string(track.property_name);
+        if (!path || !type_name || !property_name) return nullptr;
+
+        // Like the other loaders, curves of unknown component types are skipped.
+        const auto *type_info = types.find_type(type_name);
+        if (!type_info) continue;
+        clip->set_curve(path, *type_info, property_name, AnimationCurve());
+    }
+
+    // Looked up once the tree is complete. The nodes of the maps do not move afterwards.
+    std::vector<AnimationCurve *> curves;
+    curves.reserve(tracks.size());
+    for (const auto &track : tracks) {
+        const auto *type_info = types.find_type(string(track.type_name));
+        curves.push_back(type_info ? clip->find_curve(string(track.path), *type_info, string(track.property_name))
+                                   : nullptr);
+    }
+
+    std::vector<AnimationEvent> events;
+    events.reserve(event_records.size());
+    for (const auto &event : event_records) {
+        events.push_back({event.time, event.id, event.int_payload, event.float_payload});
+    }
+    clip->set_events(std::move(events));
+    clip->set_duration(header.duration);
+
+    clip->set_stream(std::unique_ptr<resources::ClipStream>(
+        new StreamingClip(std::move(file), header, std::move(chunks), std::move(curves))));
+    return clip;
+}
+
+} // namespace serialization
+} // namespace nodec_animation
+
+#endif
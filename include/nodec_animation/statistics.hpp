@@ -0,0 +1,124 @@
+#ifndef NODEC_ANIMATION__STATISTICS_HPP_
+#define NODEC_ANIMATION__STATISTICS_HPP_
+
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * Statistics are collected only if NODEC_ANIMATION_ENABLE_STATISTICS is defined
+ * (the CMake option of the same name). Otherwise the counting statements compile to nothing.
+ */
+#ifdef NODEC_ANIMATION_ENABLE_STATISTICS
+#    define NODEC_ANIMATION_STATISTICS(...) __VA_ARGS__
+#else
+#    define NODEC_ANIMATION_STATISTICS(...)
+#endif
+
+namespace nodec_animation {
+
+namespace resources {
+class AnimationClip;
+}
+
+/**
+ * @brief Counters incremented on the hot path of the evaluation.
+ */
+struct EvaluationCounters {
+    std::uint64_t curves_evaluated{0};
+
+    /**
+     * @brief Evaluations which found the keyframe from the hint without searching.
+     */
+    std::uint64_t hint_hits{0};
+
+    /**
+     * @brief Evaluations which had to search the keyframes with upper_bound.
+     */
+    std::uint64_t upper_bound_fallbacks{0};
+
+    std::uint64_t property_writes{0};
+};
+
+namespace impl {
+
+/**
+ * @brief The counters of the calling thread.
+ */
+inline EvaluationCounters &evaluation_counters() noexcept {
+    thread_local EvaluationCounters counters;
+    return counters;
+}
+
+} // namespace impl
+
+struct ClipStatistics {
+    std::uint64_t bound_entities{0};
+    std::uint64_t curves_evaluated{0};
+    std::uint64_t property_writes{0};
+};
+
+/**
+ * @brief Statistics of the last AnimatorSystem::update.
+ */
+struct AnimatorStatistics {
+    std::uint64_t active_animators{0};
+    std::uint64_t bound_entities{0};
+    std::uint64_t curves_evaluated{0};
+    std::uint64_t hint_hits{0};
+    std::uint64_t upper_bound_fallbacks{0};
+    std::uint64_t property_writes{0};
+
+    /**
+     * @brief Animated components whose type is not registered in the ComponentRegistry.
+     */
+    std::uint64_t handler_misses{0};
+
+    /**
+     * @brief Entities marked with LazyEvaluation whose pose the update did not write.
+     */
+    std::uint64_t lazy_entities_skipped{0};
+
+    /**
+     * @brief Poses written by AnimatorSystem::evaluate() since the update.
+     * Together with the skipped entities, it tells the evaluations avoided.
+     */
+    std::uint64_t lazy_evaluations{0};
+
+    double start_stop_seconds{0.0};
+    double evaluation_seconds{0.0};
+
+    /**
+     * @brief The statistics per clip evaluated in the last update.
+     *
+     * Entries of clips still evaluated are kept across updates to avoid reallocation. Those of clips no longer
+     * evaluated are dropped on the next reset, so that the map does not grow with every clip ever loaded,
+     * and a freed clip's address is not left behind as a key.
+     */
+    std::unordered_map<const resources::AnimationClip *, ClipStatistics> clips;
+
+    void reset() {
+        active_animators = 0;
+        bound_entities = 0;
+        curves_evaluated = 0;
+        hint_hits = 0;
+        upper_bound_fallbacks = 0;
+        property_writes = 0;
+        handler_misses = 0;
+        lazy_entities_skipped = 0;
+        lazy_evaluations = 0;
+        start_stop_seconds = 0.0;
+        evaluation_seconds = 0.0;
+        for (auto iter = clips.begin(); iter != clips.end();) {
+            if (iter->second.bound_entities == 0) {
+                iter = clips.erase(iter);
+                continue;
+            }
+            iter->second = ClipStatistics{};
+            ++iter;
+        }
+    }
+};
+
+} // namespace nodec_animation
+
+#endif
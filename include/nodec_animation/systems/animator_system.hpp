@@ -4,16 +4,84 @@
 #include <nodec_scene/scene_registry.hpp>
 #include <nodec_scene_serialization/scene_serialization.hpp>
 
+#include "../animator_command_queue.hpp"
 #include "../component_registry.hpp"
 #include "../components/animator.hpp"
+#include "../components/animator_controller.hpp"
 #include "../components/impl/animated_data.hpp"
 #include "../components/impl/animator_activity.hpp"
+#include "../components/impl/animator_controller_activity.hpp"
+#include "../parallel_executor.hpp"
+#include "../playback_time.hpp"
+#include "../property_mask.hpp"
+#include "../serialization/snapshot.hpp"
+#include "../statistics.hpp"
+#include "../tracing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
 
 namespace nodec_animation {
 namespace systems {
 
+/**
+ * @brief An event which playback has passed during the last update.
+ */
+struct FiredAnimationEvent {
+    /**
+     * @brief The animator entity.
+     */
+    nodec_scene::SceneEntity entity;
+    AnimationEvent event;
+};
+
+/**
+ * @brief The order in which AnimatorSystem evaluates the animated entities.
+ */
+enum class EvaluationOrder {
+    /**
+     * @brief The storage order of AnimatedData, which start and stop churn interleaves across animators and clips.
+     */
+    storage,
+
+    /**
+     * @brief Grouped by clip, and by animator in hierarchy order within a clip, so that consecutive entities share
+     * curves and component pools. The order is kept up as entities are bound.
+     */
+    clip_hierarchy,
+};
+
 class AnimatorSystem {
 public:
+    /**
+     * @brief Upper bound of whole loops whose events are fired in a single update.
+     *
+     * It only matters when the delta time is many times longer than a looping clip.
+     */
+    static constexpr int max_event_loops_per_update = 16;
+
+    /**
+     * @brief Upper bound of the AnimatedData kept for reuse after their animators have been stopped.
+     */
+    static constexpr std::size_t max_pooled_animated_data = 1 << 14;
+
+    /**
+     * @brief Upper bound of the entities bound again in a single update after their clips have changed.
+     *
+     * The animators are remapped whole, so at least one is remapped per update however many entities it animates.
+     * The entities waiting for their animator to be remapped keep their last pose.
+     */
+    static constexpr std::size_t max_remapped_entities_per_update = 1024;
+
+    /**
+     * @brief The number of animators started in an update from which they are resolved on the executor.
+     */
+    static constexpr std::size_t min_parallel_bind_jobs = 64;
+
     AnimatorSystem(ComponentRegistry &registry)
         : component_registry_(registry) {}
 
@@ -22,131 +90,1618 @@ public:
         using namespace components;
         using namespace components::impl;
 
+        ScopedTraceZone update_zone(tracer_, "AnimatorSystem::update");
+
+        const std::int64_t delta_ticks = ticks_per_second_ > 0 ? seconds_to_ticks(delta_time, ticks_per_second_) : 0;
+
+        NODEC_ANIMATION_STATISTICS(statistics_.reset());
+        NODEC_ANIMATION_STATISTICS(auto phase_begin = std::chrono::steady_clock::now());
+
+        {
+            ScopedTraceZone zone(tracer_, "commands");
+            command_queue_.drain(commands_);
+            take_deferred_commands();
+            for (auto &command : commands_) {
+                apply_start_stop(registry, command);
+            }
+        }
         {
+            ScopedTraceZone zone(tracer_, "AnimatorStart");
             auto view = registry.view<Animator, AnimatorStart>();
+            started_entities_.clear();
 
             view.each([&](SceneEntity entity, Animator &animator, AnimatorStart &) {
+                if (animator.clip_request) {
+                    // The start is deferred until the clip has been loaded.
+                    if (!animator.clip_request->ready()) return;
+                    animator.clip = animator.clip_request->clip();
+                    animator.clip_request.reset();
+                }
+                started_entities_.push_back(entity);
+
                 auto animator_activity_result = registry.emplace_component<AnimatorActivity>(entity);
                 auto &animator_activity = animator_activity_result.first;
                 auto animator_activity_created = animator_activity_result.second;
 
                 if (animator_activity_created) {
                     // At first time to create animator activity.
-                    bind(animator, registry, entity, animator_activity);
+                    if (!entity_list_pool_.empty()) {
+                        animator_activity.animated_entities = std::move(entity_list_pool_.back());
+                        entity_list_pool_.pop_back();
+                    }
+                    prepare_bind(animator, entity, animator_activity);
                     return;
                 }
 
+                registry.remove_component<AnimatorFinished>(entity);
+
                 if (animator_activity.clip != animator.clip) {
                     // Previously created animator activity is not matched with the new animator.
                     // So, we need to clear the previous AnimatedData and rebind.
 
-                    registry.remove_component<AnimatedData>(animator_activity.animated_entities.begin(),
-                                                            animator_activity.animated_entities.end());
-                    animator_activity.animated_entities.clear();
-                    bind(animator, registry, entity, animator_activity);
+                    unbind(registry, animator_activity);
+                    prepare_bind(animator, entity, animator_activity);
 
                     return;
                 }
 
                 // The animator activity is already created and matched with the new animator.
-                // So, we don't need to rebind, but we need to reset the animation time.
-                reset_animation_time(registry, animator_activity);
+                // So, we don't need to rebind, but we need to wake up the finished entities
+                // and reset the animation time.
+                wake_up(registry, animator_activity);
+                reset_animation_time(registry, animator, animator_activity);
             });
 
-            registry.remove_component<AnimatorStart>(view.begin(), view.end());
+            bind_prepared(registry);
         }
         {
+            ScopedTraceZone zone(tracer_, "AnimatorStop");
             auto view = registry.view<Animator, AnimatorStop>();
 
             view.each([&](SceneEntity entity, Animator &animator, AnimatorStop &) {
+                // A start deferred until its clip is loaded is cancelled, as if it had started above.
+                if (animator.clip_request) {
+                    animator.clip_request.reset();
+                    registry.remove_component<AnimatorStart>(entity);
+                }
+
                 auto animator_activity = registry.try_get_component<AnimatorActivity>(entity);
                 if (!animator_activity) return;
 
-                registry.remove_component<AnimatedData>(animator_activity->animated_entities.begin(),
-                                                        animator_activity->animated_entities.end());
+                unbind(registry, *animator_activity);
+                entity_list_pool_.push_back(std::move(animator_activity->animated_entities));
                 registry.remove_component<AnimatorActivity>(entity);
+                registry.remove_component<AnimatorFinished>(entity);
+            });
+        }
+        {
+            ScopedTraceZone zone(tracer_, "AnimatorController start/stop");
+            auto view = registry.view<AnimatorController, AnimatorStart>();
+
+            view.each([&](SceneEntity entity, AnimatorController &controller, AnimatorStart &) {
+                // The controller of an entity whose animator waits for its clip starts along with the animator.
+                auto *animator = registry.try_get_component<Animator>(entity);
+                if (animator && animator->clip_request) return;
+
+                // An entity with an animator is already in the list.
+                if (!animator) started_entities_.push_back(entity);
+
+                auto &controller_activity = registry.emplace_component<AnimatorControllerActivity>(entity).first;
+                start_controller(registry, entity, controller, controller_activity);
+            });
+        }
+        {
+            auto view = registry.view<AnimatorController, AnimatorStop>();
+
+            registry.remove_component<AnimatorControllerActivity>(view.begin(), view.end());
+        }
+        {
+            // Removed once both the animator and the controller phases have seen them,
+            // since an entity may have an animator and a controller.
+            registry.remove_component<AnimatorStart>(started_entities_.begin(), started_entities_.end());
+
+            auto animator_view = registry.view<Animator, AnimatorStop>();
+            registry.remove_component<AnimatorStop>(animator_view.begin(), animator_view.end());
+            auto controller_view = registry.view<AnimatorController, AnimatorStop>();
+            registry.remove_component<AnimatorStop>(controller_view.begin(), controller_view.end());
+        }
+
+        {
+            // Seeks and speeds apply to the animators just started as well.
+            ScopedTraceZone zone(tracer_, "commands");
+            for (auto &command : commands_) {
+                apply_playback(registry, command);
+            }
+            commands_.clear();
+        }
+
+        {
+            ScopedTraceZone zone(tracer_, "remap");
+            remap_budget_ = max_remapped_entities_per_update;
+
+            // Collected first, since remapping adds and removes AnimatedData.
+            stale_entities_.clear();
+            registry.view<AnimatorActivity>().each([&](SceneEntity entity, AnimatorActivity &animator_activity) {
+                if (is_stale(animator_activity)) stale_entities_.push_back(entity);
+            });
+
+            for (auto &entity : stale_entities_) {
+                if (remap_budget_ == 0) break;
+                remap(registry, entity, registry.get_component<AnimatorActivity>(entity));
+            }
+        }
+
+        NODEC_ANIMATION_STATISTICS(statistics_.start_stop_seconds = seconds_since(phase_begin));
+        NODEC_ANIMATION_STATISTICS(phase_begin = std::chrono::steady_clock::now());
+        NODEC_ANIMATION_STATISTICS(const auto counters_begin = nodec_animation::impl::evaluation_counters());
+
+        finished_entities_.clear();
+
+        {
+            ScopedTraceZone evaluation_zone(tracer_, "evaluate");
+
+            // The marker is only looked up per entity while some entity has it.
+            bool any_lazy_entities;
+            {
+                auto view = registry.view<LazyEvaluation>();
+                any_lazy_entities = view.begin() != view.end();
+            }
+
+            auto evaluate_entity = [&](SceneEntity entity, AnimatedData &animated_data) {
+                if (animated_data.is_stale()) {
+                    // The clip has changed, and the animator has not been remapped to it yet.
+                    advance(animated_data.time, animated_data.ticks, delta_time, delta_ticks, animated_data.speed);
+                    return;
+                }
+
+                auto *lazy_evaluation = any_lazy_entities ? registry.try_get_component<LazyEvaluation>(entity) : nullptr;
+                if (lazy_evaluation) {
+                    NODEC_ANIMATION_STATISTICS(++statistics_.lazy_entities_skipped);
+                    lazy_evaluation->pending = true;
+                    lazy_evaluation->time = animated_data.time;
+                    lazy_evaluation->ticks = animated_data.ticks;
+
+                    if (is_finished(*animated_data.clip(), animated_data.time, animated_data.speed)) {
+                        finished_entities_.push_back(entity);
+                        return;
+                    }
+                    advance(animated_data.time, animated_data.ticks, delta_time, delta_ticks, animated_data.speed);
+                    return;
+                }
+
+                NODEC_ANIMATION_STATISTICS(const auto entity_counters_begin = nodec_animation::impl::evaluation_counters());
+
+                const auto time = playback_time(animated_data.time, animated_data.ticks);
+                prepare_stream(*animated_data.clip(), time.seconds);
+                write_entity(registry, entity, animated_data.component_animation_states, time, 1.f);
+
+                NODEC_ANIMATION_STATISTICS(record_clip_statistics(animated_data.clip().get(), entity_counters_begin));
+
+                if (is_finished(*animated_data.clip(), time.seconds, animated_data.speed)) {
+                    // The final pose has just been written. There is nothing left to evaluate.
+                    finished_entities_.push_back(entity);
+                    return;
+                }
+
+                advance(animated_data.time, animated_data.ticks, delta_time, delta_ticks, animated_data.speed);
+            };
+
+            if (evaluation_order_ == EvaluationOrder::clip_hierarchy) {
+                for_each_in_evaluation_order(registry, evaluate_entity);
+            } else {
+                registry.view<AnimatedData>().each(evaluate_entity);
+            }
+        }
+
+        fired_events_.clear();
+
+        {
+            ScopedTraceZone zone(tracer_, "events");
+            registry.view<AnimatorActivity>().each([&](SceneEntity entity, AnimatorActivity &animator_activity) {
+                if (animator_activity.sleeping || !animator_activity.clip) return;
+                NODEC_ANIMATION_STATISTICS(++statistics_.active_animators);
+
+                if (ticks_per_second_ > 0) wrap_ticks(animator_activity);
+                // The events of a changed clip are fired once the animator has been remapped to it.
+                if (!is_stale(animator_activity)) fire_events(entity, animator_activity);
+                advance(animator_activity.time, animator_activity.ticks, delta_time, delta_ticks, animator_activity.speed);
             });
+        }
+
+        for (auto &entity : finished_entities_) {
+            sleep(registry, entity);
+        }
+
+        {
+            ScopedTraceZone zone(tracer_, "AnimatorController update");
+            registry.view<AnimatorController, AnimatorControllerActivity>().each(
+                [&](SceneEntity entity, AnimatorController &controller, AnimatorControllerActivity &controller_activity) {
+                    if (!controller_activity.description || controller_activity.current_state < 0) return;
+                    if (is_stale(controller_activity)) {
+                        if (remap_budget_ == 0) return;
+                        remap(registry, entity, controller_activity);
+                    }
+                    NODEC_ANIMATION_STATISTICS(++statistics_.active_animators);
+                    update_controller(registry, controller, controller_activity, delta_time, delta_ticks);
+                });
+        }
+
+        NODEC_ANIMATION_STATISTICS({
+            const auto &counters = nodec_animation::impl::evaluation_counters();
+            statistics_.curves_evaluated = counters.curves_evaluated - counters_begin.curves_evaluated;
+            statistics_.hint_hits = counters.hint_hits - counters_begin.hint_hits;
+            statistics_.upper_bound_fallbacks = counters.upper_bound_fallbacks - counters_begin.upper_bound_fallbacks;
+            statistics_.property_writes = counters.property_writes - counters_begin.property_writes;
+            statistics_.evaluation_seconds = seconds_since(phase_begin);
+        });
+    }
+
+    /**
+     * @brief Returns the statistics of the last update.
+     *
+     * They are collected only when NODEC_ANIMATION_ENABLE_STATISTICS is defined, and stay zero otherwise.
+     */
+    const AnimatorStatistics &statistics() const noexcept {
+        return statistics_;
+    }
 
-            registry.remove_component<AnimatorStop>(view.begin(), view.end());
+    /**
+     * @brief Sets the order in which the entities are evaluated. It is EvaluationOrder::clip_hierarchy by default.
+     */
+    void set_evaluation_order(EvaluationOrder evaluation_order) {
+        evaluation_order_ = evaluation_order;
+        evaluation_groups_.clear();
+        evaluation_group_indices_.clear();
+        evaluation_order_outdated_ = evaluation_order == EvaluationOrder::clip_hierarchy;
+    }
+
+    EvaluationOrder evaluation_order() const noexcept {
+        return evaluation_order_;
+    }
+
+    /**
+     * @brief Writes the pose pending for the entity marked with LazyEvaluation, as the last update would have written it.
+     *
+     * If the entity is an animator, the poses of all entities it animates are written.
+     * Poses already written since the last update are not evaluated again.
+     *
+     * @return the number of entities whose pose has been written.
+     */
+    std::size_t evaluate(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity) {
+        using namespace components::impl;
+
+        ScopedTraceZone zone(tracer_, "AnimatorSystem::evaluate");
+
+        auto *animator_activity = registry.try_get_component<AnimatorActivity>(entity);
+        if (!animator_activity) return evaluate_lazy(registry, entity) ? 1 : 0;
+
+        std::size_t count = 0;
+        for (auto &animated_entity : animator_activity->animated_entities) {
+            if (evaluate_lazy(registry, animated_entity)) ++count;
         }
+        return count;
+    }
+
+    /**
+     * @brief The queue through which other threads play, stop, seek and change the speed of animators.
+     *
+     * The commands are applied at the beginning of the next update.
+     */
+    AnimatorCommandQueue &command_queue() noexcept {
+        return command_queue_;
+    }
+
+    /**
+     * @brief Sets the executor on which the animators started in an update are bound in parallel, or nullptr to bind
+     * them on the calling thread. The executor must outlive the system.
+     */
+    void set_executor(ParallelExecutor *executor) noexcept {
+        executor_ = executor;
+    }
+
+    /**
+     * @brief Sets the tracer receiving the zones of each update, or nullptr to disable tracing.
+     *
+     * The tracer is not owned and must outlive its use by this system.
+     */
+    void set_tracer(Tracer *tracer) noexcept {
+        tracer_ = tracer;
+    }
+
+    Tracer *tracer() const noexcept {
+        return tracer_;
+    }
+
+    /**
+     * @brief Runs playback in a tick time base of the given rate, or in seconds if zero, which is the default.
+     *
+     * Playback times are then accumulated in 64-bit integer ticks, and looping curves wrap them by integer arithmetic,
+     * so that playback stays exact however long it runs. Each delta time is rounded to whole ticks:
+     * a rate which is a multiple of the frame rate, e.g. 60000 at 60 fps, takes fixed delta times exactly.
+     *
+     * Set it before starting any animator. The clips are prepared for the rate when their animators start.
+     */
+    void set_ticks_per_second(std::uint32_t ticks_per_second) noexcept {
+        ticks_per_second_ = ticks_per_second;
+    }
+
+    std::uint32_t ticks_per_second() const noexcept {
+        return ticks_per_second_;
+    }
+
+    /**
+     * @brief Restricts the animated properties written by this system to those included by the mask.
+     *
+     * The mask is applied when animators and controllers are bound: they are bound to the included properties
+     * of the clip, which are collected once per clip and referred to rather than copied. Excluded properties,
+     * and entities left without any, are never visited per frame. Animators already bound keep the properties
+     * they were bound with.
+     */
+    void set_property_mask(PropertyMask mask) {
+        property_mask_ = std::move(mask);
+        masked_clips_.clear();
+    }
+
+    const PropertyMask &property_mask() const noexcept {
+        return property_mask_;
+    }
+
+    /**
+     * @brief Frees the runtime state kept for reuse by animators started after others were stopped.
+     */
+    void clear_pools() {
+        animated_data_pool_.clear();
+        animated_data_pool_.shrink_to_fit();
+        entity_list_pool_.clear();
+        entity_list_pool_.shrink_to_fit();
+    }
+
+    /**
+     * @brief Returns the events fired during the last update, in the order of playback per animator.
+     *
+     * The buffer is reused and overwritten by the next update.
+     */
+    const std::vector<FiredAnimationEvent> &fired_events() const noexcept {
+        return fired_events_;
+    }
+
+    /**
+     * @brief Writes the runtime state of all bound animators and controllers into the buffer, replacing its contents.
+     *
+     * The snapshot holds the playback times, sleep states, event cursors, controller states and parameters,
+     * and the curve hints, so that evaluation after a restore is as fast as before it.
+     * See serialization/snapshot.hpp for the layout and for delta encoding between snapshots.
+     */
+    void save_snapshot(nodec_scene::SceneRegistry &registry, std::vector<char> &buffer) {
+        using namespace components;
+        using namespace components::impl;
+        using namespace serialization;
 
-        registry.view<AnimatedData>().each([&](SceneEntity entity, AnimatedData &animated_data) {
-            for (auto &component : animated_data.animated_entity()->components) {
-                auto &animated_component = component.second;
-                auto &type_info = component.first;
+        buffer.clear();
+        append_snapshot(buffer, SnapshotHeader());
 
-                auto *handler = component_registry_.get_handler(type_info);
-                if (!handler) continue;
+        SnapshotHeader header{{'N', 'A', 'S', 'N'}, snapshot_version, 0, 0, 0, 0};
 
-                auto &state = animated_data.component_animation_states[type_info];
+        registry.view<AnimatorActivity>().each([&](nodec_scene::SceneEntity entity, AnimatorActivity &animator_activity) {
+            const auto record_offset = buffer.size();
+            SnapshotAnimator record{};
+            record.entity = entity_to_id(entity);
+            record.sleeping = animator_activity.sleeping ? 1 : 0;
+            record.ticks = animator_activity.ticks;
+            record.time = animator_activity.time;
+            record.speed = animator_activity.speed;
+            record.event_time = animator_activity.event_time;
+            record.event_cursor = static_cast<std::uint32_t>(animator_activity.event_cursor);
+            record.animated_entity_count = static_cast<std::uint32_t>(animator_activity.animated_entities.size());
+            append_snapshot(buffer, record);
+
+            for (const auto &animated_entity : animator_activity.animated_entities) {
+                const auto *animated_data = find_animated_data(registry, animated_entity);
+                SnapshotAnimatedData data_record{};
+                if (animated_data) {
+                    data_record.ticks = animated_data->ticks;
+                    data_record.time = animated_data->time;
+                    data_record.speed = animated_data->speed;
+                }
+                data_record.sleeping = registry.try_get_component<AnimatedData>(animated_entity) ? 0 : 1;
+                append_snapshot(buffer, data_record);
+            }
 
-                handler->write_properties(registry, entity, animated_component, animated_data.time,
-                                          &state);
-                animated_data.time += delta_time;
+            for (const auto &animated_entity : animator_activity.animated_entities) {
+                const auto *animated_data = find_animated_data(registry, animated_entity);
+                if (!animated_data) continue;
+                record.hint_count += save_hints(animated_data->component_animation_states, buffer);
             }
+
+            std::memcpy(buffer.data() + record_offset, &record, sizeof(record));
+            ++header.animator_count;
         });
+
+        registry.view<AnimatorController, AnimatorControllerActivity>().each(
+            [&](nodec_scene::SceneEntity entity, AnimatorController &controller, AnimatorControllerActivity &controller_activity) {
+                const auto record_offset = buffer.size();
+                SnapshotController record{};
+                record.entity = entity_to_id(entity);
+                record.current_state = controller_activity.current_state;
+                record.current_ticks = controller_activity.current_ticks;
+                record.current_time = controller_activity.current_time;
+                record.next_state = controller_activity.next_state;
+                record.next_ticks = controller_activity.next_ticks;
+                record.next_time = controller_activity.next_time;
+                record.transition_elapsed = controller_activity.transition_elapsed;
+                record.transition_duration = controller_activity.transition_duration;
+                record.parameter_count = static_cast<std::uint32_t>(controller.parameters.size());
+                append_snapshot(buffer, record);
+
+                for (const auto parameter : controller.parameters) append_snapshot(buffer, parameter);
+                for (const auto &binding : controller_activity.bindings) {
+                    record.hint_count += save_hints(binding.component_animation_states, buffer);
+                }
+
+                std::memcpy(buffer.data() + record_offset, &record, sizeof(record));
+                ++header.controller_count;
+            });
+
+        header.size = static_cast<std::uint32_t>(buffer.size());
+        std::memcpy(buffer.data(), &header, sizeof(header));
+    }
+
+    /**
+     * @brief Restores the state written by save_snapshot() without rebinding.
+     *
+     * The animators and controllers must still be bound as they were when the snapshot was saved. Those started
+     * since then are left as they are. Entities put to sleep or woken up since then are moved back.
+     *
+     * @return false if the snapshot is invalid or does not match the bindings. The state may then be partly restored.
+     */
+    bool restore_snapshot(nodec_scene::SceneRegistry &registry, const char *data, std::size_t size) {
+        using namespace components;
+        using namespace components::impl;
+        using namespace serialization;
+
+        SnapshotReader reader(data, size);
+        SnapshotHeader header;
+        if (!reader.read(header)) return false;
+        if (std::memcmp(header.magic, "NASN", 4) != 0 || header.version != snapshot_version || header.size != size) {
+            return false;
+        }
+
+        for (std::uint32_t i = 0; i < header.animator_count; ++i) {
+            SnapshotAnimator record;
+            if (!reader.read(record)) return false;
+
+            const auto entity = id_to_entity(record.entity);
+            auto *animator_activity = registry.try_get_component<AnimatorActivity>(entity);
+            if (!animator_activity || !animator_activity->clip
+                || animator_activity->animated_entities.size() != record.animated_entity_count
+                || animator_activity->clip->events().size() < record.event_cursor) {
+                return false;
+            }
+
+            animator_activity->sleeping = record.sleeping != 0;
+            if (animator_activity->sleeping) {
+                registry.emplace_component<AnimatorFinished>(entity);
+            } else {
+                registry.remove_component<AnimatorFinished>(entity);
+            }
+            animator_activity->ticks = record.ticks;
+            animator_activity->time = record.time;
+            animator_activity->speed = record.speed;
+            animator_activity->event_time = record.event_time;
+            animator_activity->event_cursor = record.event_cursor;
+
+            for (const auto &animated_entity : animator_activity->animated_entities) {
+                SnapshotAnimatedData data_record;
+                if (!reader.read(data_record)) return false;
+
+                auto *animated_data = set_sleeping(registry, animated_entity, data_record.sleeping != 0);
+                if (!animated_data) return false;
+                animated_data->ticks = data_record.ticks;
+                animated_data->time = data_record.time;
+                animated_data->speed = data_record.speed;
+            }
+
+            std::uint32_t hint_count = 0;
+            for (const auto &animated_entity : animator_activity->animated_entities) {
+                auto *animated_data = find_animated_data(registry, animated_entity);
+                if (!restore_hints(animated_data->component_animation_states, reader, hint_count)) return false;
+            }
+            if (hint_count != record.hint_count) return false;
+        }
+
+        for (std::uint32_t i = 0; i < header.controller_count; ++i) {
+            SnapshotController record;
+            if (!reader.read(record)) return false;
+
+            const auto entity = id_to_entity(record.entity);
+            auto *controller = registry.try_get_component<AnimatorController>(entity);
+            auto *controller_activity = registry.try_get_component<AnimatorControllerActivity>(entity);
+            if (!controller || !controller_activity || controller->parameters.size() != record.parameter_count) {
+                return false;
+            }
+
+            const auto state_count = controller_activity->description
+                                         ? static_cast<std::int32_t>(controller_activity->description->compiled_states().size())
+                                         : 0;
+            if (state_count <= record.current_state || state_count <= record.next_state) return false;
+
+            controller_activity->current_state = record.current_state;
+            controller_activity->current_ticks = record.current_ticks;
+            controller_activity->current_time = record.current_time;
+            controller_activity->next_state = record.next_state;
+            controller_activity->next_ticks = record.next_ticks;
+            controller_activity->next_time = record.next_time;
+            controller_activity->transition_elapsed = record.transition_elapsed;
+            controller_activity->transition_duration = record.transition_duration;
+
+            for (auto &parameter : controller->parameters) {
+                if (!reader.read(parameter)) return false;
+            }
+
+            std::uint32_t hint_count = 0;
+            for (auto &binding : controller_activity->bindings) {
+                if (!restore_hints(binding.component_animation_states, reader, hint_count)) return false;
+            }
+            if (hint_count != record.hint_count) return false;
+        }
+
+        return reader.at_end();
     }
 
 private:
+    using ComponentAnimationStates = components::impl::ComponentAnimationStates;
+
+    struct ResolvedBinding {
+        nodec_scene::SceneEntity entity;
+        const resources::AnimatedEntity *animated_entity;
+
+        /**
+         * @brief The properties included by the property mask, or nullptr if the clip is not masked.
+         */
+        const MaskedEntityTree::IncludedEntity *included;
+    };
+
+    struct BindJob {
+        nodec_scene::SceneEntity entity;
+
+        /**
+         * @brief The entity tree the animator binds, or nullptr if it has no clip.
+         */
+        const resources::AnimatedEntity *root;
+
+        /**
+         * @brief The part of the tree the property mask includes, or nullptr if the clip is not masked.
+         */
+        std::shared_ptr<const MaskedEntityTree> masked_tree;
+        std::vector<ResolvedBinding> bindings;
+    };
+
+    /**
+     * @brief The time an entity newly bound by a remap starts at, so that it plays in step with the others.
+     */
+    struct RemapTiming {
+        float time;
+        std::int64_t ticks;
+        float speed;
+    };
+
+    bool evaluate_lazy(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity) {
+        using namespace components;
+
+        auto *lazy_evaluation = registry.try_get_component<LazyEvaluation>(entity);
+        if (!lazy_evaluation || !lazy_evaluation->pending) return false;
+
+        auto *animated_data = find_animated_data(registry, entity);
+        if (!animated_data || !animated_data->clip() || animated_data->is_stale()) return false;
+
+        lazy_evaluation->pending = false;
+        NODEC_ANIMATION_STATISTICS(++statistics_.lazy_evaluations);
+
+        const auto time = playback_time(lazy_evaluation->time, lazy_evaluation->ticks);
+        prepare_stream(*animated_data->clip(), time.seconds);
+        write_entity(registry, entity, animated_data->component_animation_states, time, 1.f);
+        return true;
+    }
+
+    void add_to_evaluation_order(const nodec_scene::SceneEntity &entity, const resources::AnimationClip *clip) {
+        // Looked up first, since emplace allocates a node even if the clip has a group already.
+        auto iter = evaluation_group_indices_.find(clip);
+        if (iter == evaluation_group_indices_.end()) {
+            iter = evaluation_group_indices_.emplace(clip, evaluation_groups_.size()).first;
+            evaluation_groups_.emplace_back();
+            evaluation_groups_.back().clip = clip;
+        }
+        evaluation_groups_[iter->second].entities.push_back(entity);
+    }
+
+    /**
+     * @brief Calls the function with the active AnimatedData group by group, dropping the entries which are outdated.
+     *
+     * Entries are only appended when entities are bound, so an entry is outdated once its entity has been unbound,
+     * rebound to another clip or appended again. Sleeping entities keep their entries for when they wake up.
+     */
+    template<class Function>
+    void for_each_in_evaluation_order(nodec_scene::SceneRegistry &registry, Function &&function) {
+        using namespace components::impl;
+
+        if (evaluation_order_outdated_) {
+            // Built from scratch once, after switching the order.
+            evaluation_order_outdated_ = false;
+            registry.view<AnimatorActivity>().each([&](nodec_scene::SceneEntity, AnimatorActivity &animator_activity) {
+                for (auto &entity : animator_activity.animated_entities) {
+                    auto *animated_data = find_animated_data(registry, entity);
+                    if (animated_data && animated_data->clip()) add_to_evaluation_order(entity, animated_data->clip().get());
+                }
+            });
+        }
+
+        ++evaluation_stamp_;
+
+        for (std::size_t group_index = 0; group_index < evaluation_groups_.size();) {
+            auto &group = evaluation_groups_[group_index];
+            auto &entities = group.entities;
+
+            std::size_t kept = 0;
+            for (auto &entity : entities) {
+                auto *active_data = registry.try_get_component<AnimatedData>(entity);
+                auto *animated_data = active_data ? active_data : find_animated_data(registry, entity);
+                if (!animated_data || animated_data->clip().get() != group.clip
+                    || animated_data->evaluation_stamp == evaluation_stamp_) {
+                    continue;
+                }
+                animated_data->evaluation_stamp = evaluation_stamp_;
+                entities[kept++] = entity;
+
+                if (active_data) function(entity, *active_data);
+            }
+            entities.resize(kept);
+
+            if (!entities.empty()) {
+                ++group_index;
+                continue;
+            }
+
+            evaluation_group_indices_.erase(group.clip);
+            if (group_index + 1 < evaluation_groups_.size()) {
+                group = std::move(evaluation_groups_.back());
+                evaluation_group_indices_[group.clip] = group_index;
+            }
+            evaluation_groups_.pop_back();
+        }
+    }
+
+    /**
+     * @brief Puts the deferred seeks and speeds in front of the commands drained, as if pushed before them.
+     */
+    void take_deferred_commands() {
+        for (auto &deferred : deferred_commands_) {
+            auto iter = std::find_if(commands_.begin(), commands_.end(), [&](const CoalescedAnimatorCommand &command) {
+                return command.entity == deferred.entity;
+            });
+            if (iter == commands_.end()) {
+                commands_.push_back(std::move(deferred));
+                continue;
+            }
+
+            // A later play or stop cancels the seek, like in CoalescedAnimatorCommand::apply().
+            if (deferred.seek && !iter->seek && !iter->play && !iter->stop) {
+                iter->seek = true;
+                iter->time = deferred.time;
+            }
+            if (deferred.set_speed && !iter->set_speed) {
+                iter->set_speed = true;
+                iter->speed = deferred.speed;
+            }
+        }
+        deferred_commands_.clear();
+    }
+
+    /**
+     * @brief Turns a play or stop command into the components the update then handles, like AnimatorStart.
+     */
+    static void apply_start_stop(nodec_scene::SceneRegistry &registry, const CoalescedAnimatorCommand &command) {
+        using namespace components;
+
+        auto *animator = registry.try_get_component<Animator>(command.entity);
+        if (animator && command.set_speed) animator->speed = command.speed;
+
+        const bool controlled = registry.try_get_component<AnimatorController>(command.entity) != nullptr;
+
+        if (command.stop && (animator || controlled)) {
+            registry.remove_component<AnimatorStart>(command.entity);
+            registry.emplace_component<AnimatorStop>(command.entity);
+        }
+
+        if (command.play) {
+            if (command.clip) {
+                if (!animator) {
+                    animator = &registry.emplace_component<Animator>(command.entity).first;
+                    if (command.set_speed) animator->speed = command.speed;
+                }
+                animator->clip = command.clip;
+                animator->clip_request.reset();
+            }
+            if (!animator && !controlled) return;
+
+            registry.remove_component<AnimatorStop>(command.entity);
+            registry.emplace_component<AnimatorStart>(command.entity);
+        }
+    }
+
+    void apply_playback(nodec_scene::SceneRegistry &registry, const CoalescedAnimatorCommand &command) {
+        using namespace components;
+        using namespace components::impl;
+
+        // The start of an animator waiting for its clip is deferred, and so are its seek and speed.
+        auto *animator = registry.try_get_component<Animator>(command.entity);
+        if (animator && animator->clip_request) {
+            if (!command.seek && !command.set_speed) return;
+            deferred_commands_.push_back(command);
+            auto &deferred = deferred_commands_.back();
+            deferred.play = false;
+            deferred.stop = false;
+            deferred.clip.reset();
+            return;
+        }
+
+        auto *animator_activity = registry.try_get_component<AnimatorActivity>(command.entity);
+        if (!animator_activity || !animator_activity->clip) return;
+
+        if (command.set_speed) {
+            for (auto &entity : animator_activity->animated_entities) {
+                if (auto *animated_data = find_animated_data(registry, entity)) animated_data->speed = command.speed;
+            }
+            animator_activity->speed = command.speed;
+        }
+
+        if (command.seek) seek(registry, command.entity, *animator_activity, command.time);
+    }
+
+    /**
+     * @brief Moves the playback of the animator to the time, waking it up if it has finished.
+     *
+     * The events between the previous and the new time are skipped.
+     */
+    void seek(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+              components::impl::AnimatorActivity &animator_activity, float time) {
+        using namespace components;
+        using namespace components::impl;
+
+        const auto ticks = ticks_per_second_ > 0 ? seconds_to_ticks(time, ticks_per_second_) : 0;
+        for (auto &animated_entity : animator_activity.animated_entities) {
+            // Entities whose curves have finished before the others sleep on their own.
+            auto *animated_data = set_sleeping(registry, animated_entity, false);
+            if (!animated_data) continue;
+            animated_data->time = time;
+            animated_data->ticks = ticks;
+        }
+
+        animator_activity.sleeping = false;
+        registry.remove_component<AnimatorFinished>(entity);
+
+        animator_activity.time = time;
+        animator_activity.ticks = ticks;
+        animator_activity.event_time = time;
+
+        const auto &clip = *animator_activity.clip;
+        const auto &events = clip.events();
+        float position = time;
+        if (clip.is_looping() && clip.duration() > 0.f) {
+            position = std::fmod(time, clip.duration());
+            if (position < 0.f) position += clip.duration();
+        }
+
+        // The cursor points past the events already passed in the direction of playback.
+        const bool reverse = animator_activity.speed < 0.f;
+        animator_activity.event_cursor = static_cast<std::size_t>(
+            std::count_if(events.begin(), events.end(), [&](const AnimationEvent &event) {
+                return reverse ? event.time <= position : event.time < position;
+            }));
+    }
+
+    /**
+     * @brief Writes the components the states have been bound to, which leaves out those the property mask excludes.
+     */
+    void write_entity(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+                      ComponentAnimationStates &states, PlaybackTime time, float weight) {
+        for (auto &component : states) {
+            auto &state = component.second;
+
+            auto *handler = component_registry_.get_handler(component.first);
+            if (!handler) {
+                NODEC_ANIMATION_STATISTICS(++statistics_.handler_misses);
+                continue;
+            }
+
+            // The name is a virtual call, made only while tracing.
+            ScopedTraceZone zone(tracer_, tracer_ ? handler->type_name() : nullptr);
+            handler->write_properties(registry, entity, *state.source, time, writer_, &state, weight);
+        }
+    }
+
+    void start_controller(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+                          components::AnimatorController &controller,
+                          components::impl::AnimatorControllerActivity &controller_activity) {
+        controller_activity.current_state = -1;
+        controller_activity.next_state = -1;
+
+        if (controller.description && !controller.description->compiled()) {
+            controller.description->compile();
+        }
+
+        if (controller_activity.description != controller.description
+            || (controller.description && controller_activity.description_version != controller.description->compiled_version())) {
+            controller_activity.description = controller.description;
+            unbind(controller_activity);
+        }
+
+        if (!controller.description) return;
+        auto &description = *controller.description;
+        controller_activity.description_version = description.compiled_version();
+
+        if (controller.parameters.size() != description.parameters().size()) {
+            controller.parameters.clear();
+            for (const auto &parameter : description.parameters()) {
+                controller.parameters.push_back(parameter.default_value);
+            }
+        }
+
+        if (controller_activity.binding_offsets.empty()) {
+            bind(registry, entity, controller_activity);
+        }
+
+        const auto default_state = description.default_state();
+        if (default_state < 0 || static_cast<int>(description.compiled_states().size()) <= default_state) return;
+
+        controller_activity.current_state = default_state;
+        controller_activity.current_time = 0.f;
+        controller_activity.current_ticks = 0;
+    }
+
+    /**
+     * @brief Binds every clip the state machine may play once up front, so that changing states never touches the hierarchy.
+     */
+    void bind(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+              components::impl::AnimatorControllerActivity &controller_activity) {
+        controller_activity.binding_offsets.push_back(0);
+        for (const auto &clip : controller_activity.description->clips()) {
+            if (ticks_per_second_ > 0) clip->prepare_ticks(ticks_per_second_);
+            const auto masked_tree = mask(clip);
+            auto &bindings = controller_activity.bindings;
+            auto collect = [&](const nodec_scene::SceneEntity &bound_entity,
+                               const resources::AnimatedEntity &animated_entity,
+                               const MaskedEntityTree::IncludedEntity *included) {
+                bindings.push_back({bound_entity, &animated_entity, {}});
+                components::impl::bind_animation_states(bindings.back().component_animation_states,
+                                                        animated_entity, included, false);
+            };
+            for_each_bound(registry, entity, clip->root_entity(), masked_tree.get(), collect);
+            controller_activity.binding_offsets.push_back(
+                static_cast<std::uint32_t>(controller_activity.bindings.size()));
+            controller_activity.clip_versions.push_back(clip->version());
+        }
+    }
+
+    static void unbind(components::impl::AnimatorControllerActivity &controller_activity) {
+        controller_activity.bindings.clear();
+        controller_activity.binding_offsets.clear();
+        controller_activity.clip_versions.clear();
+    }
+
+    /**
+     * @brief Binds the controller to its changed clips again.
+     *
+     * Unlike animators, controllers are bound anew: their bindings are found without touching any component.
+     */
+    void remap(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+               components::impl::AnimatorControllerActivity &controller_activity) {
+        ScopedTraceZone zone(tracer_, "remap");
+
+        unbind(controller_activity);
+        bind(registry, entity, controller_activity);
+        remap_budget_ -= (std::min)(remap_budget_, controller_activity.bindings.size());
+    }
+
+    static bool is_stale(const components::impl::AnimatorControllerActivity &controller_activity) noexcept {
+        const auto &clips = controller_activity.description->clips();
+        for (std::size_t i = 0; i < clips.size() && i < controller_activity.clip_versions.size(); ++i) {
+            if (clips[i]->version() != controller_activity.clip_versions[i]) return true;
+        }
+        return false;
+    }
+
+    static bool is_stale(const components::impl::AnimatorActivity &animator_activity) noexcept {
+        return animator_activity.clip && animator_activity.clip_version != animator_activity.clip->version();
+    }
+
+    /**
+     * @brief Binds the animator to its changed clip again, reusing the AnimatedData of the entities still animated.
+     *
+     * The reused data keep their time and the hints of the properties still animated. The data of entities bound anew
+     * start at the time of the animator entity, and those of entities no longer animated are removed.
+     */
+    void remap(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+               components::impl::AnimatorActivity &animator_activity) {
+        using namespace components::impl;
+
+        auto &clip = animator_activity.clip;
+        if (ticks_per_second_ > 0) clip->prepare_ticks(ticks_per_second_);
+
+        RemapTiming timing{animator_activity.time, animator_activity.ticks, animator_activity.speed};
+        if (const auto *root_data = find_animated_data(registry, entity)) {
+            timing = {root_data->time, root_data->ticks, root_data->speed};
+        }
+
+        remapped_entities_.swap(animator_activity.animated_entities);
+        animator_activity.animated_entities.clear();
+
+        const auto masked_tree = mask(clip);
+        remapped_bindings_.clear();
+        resolve(registry, entity, clip->root_entity(), masked_tree.get(), remapped_bindings_);
+        commit(registry, remapped_bindings_, clip, animator_activity, &timing);
+
+        for (auto &previous_entity : remapped_entities_) {
+            auto *animated_data = find_animated_data(registry, previous_entity);
+            if (!animated_data || !animated_data->is_stale()) continue;
+
+            // No longer animated by the changed clip.
+            if (animated_data_pool_.size() < max_pooled_animated_data) {
+                animated_data->release();
+                animated_data_pool_.push_back(std::move(*animated_data));
+            }
+            registry.remove_component<AnimatedData>(previous_entity);
+            registry.remove_component<SleepingAnimatedData>(previous_entity);
+        }
+
+        animator_activity.clip_version = clip->version();
+        animator_activity.event_cursor = (std::min)(animator_activity.event_cursor, clip->events().size());
+        remap_budget_ -= (std::min)(remap_budget_, animator_activity.animated_entities.size());
+    }
+
+    void update_controller(nodec_scene::SceneRegistry &registry,
+                           components::AnimatorController &controller,
+                           components::impl::AnimatorControllerActivity &controller_activity,
+                           float delta_time, std::int64_t delta_ticks) {
+        using resources::AnimatorDescription;
+
+        const auto &description = *controller_activity.description;
+        const auto &states = description.compiled_states();
+
+        if (controller_activity.next_state < 0) {
+            const auto &state = states[controller_activity.current_state];
+            const auto &transitions = description.compiled_transitions();
+            const auto &conditions = description.compiled_conditions();
+
+            // The duration is read from the clip, since it changes when the clip is edited or streamed.
+            const auto *clip = state.clip >= 0 ? description.clips()[state.clip].get() : nullptr;
+            const float duration = clip ? clip->duration() : 0.f;
+            const float normalized_time = duration > 0.f ? controller_activity.current_time / duration : 1.f;
+            const float loop_time = clip && clip->is_looping() && duration > 0.f
+                                        ? normalized_time - std::floor(normalized_time)
+                                        : normalized_time;
+
+            for (auto transition_index = state.transition_begin; transition_index < state.transition_end; ++transition_index) {
+                const auto &transition = transitions[transition_index];
+
+                bool passed = transition.exit_time < 0.f
+                              || transition.exit_time <= (transition.exit_time < 1.f ? loop_time : normalized_time);
+                for (auto condition_index = transition.condition_begin; condition_index < transition.condition_end; ++condition_index) {
+                    const auto &condition = conditions[condition_index];
+                    const auto result = AnimatorDescription::compare(controller.parameters[condition.parameter], condition.threshold);
+                    passed &= (result & condition.mask) != 0;
+                }
+                if (!passed) continue;
+
+                for (auto condition_index = transition.condition_begin; condition_index < transition.condition_end; ++condition_index) {
+                    const auto &condition = conditions[condition_index];
+                    if (condition.consume) controller.parameters[condition.parameter] = 0.f;
+                }
+
+                if (transition.duration <= 0.f) {
+                    controller_activity.current_state = static_cast<int>(transition.destination);
+                    controller_activity.current_time = 0.f;
+                    controller_activity.current_ticks = 0;
+                } else {
+                    controller_activity.next_state = static_cast<int>(transition.destination);
+                    controller_activity.next_time = 0.f;
+                    controller_activity.next_ticks = 0;
+                    controller_activity.transition_elapsed = 0.f;
+                    controller_activity.transition_duration = transition.duration;
+                }
+                break;
+            }
+        }
+
+        // Only the current state and the destination of the crossfade are evaluated.
+        write_controller_state(registry, controller_activity, controller_activity.current_state,
+                               playback_time(controller_activity.current_time, controller_activity.current_ticks), 1.f);
+        advance(controller_activity.current_time, controller_activity.current_ticks, delta_time, delta_ticks,
+                states[controller_activity.current_state].speed);
+
+        if (controller_activity.next_state < 0) return;
+
+        const float weight = controller_activity.transition_elapsed / controller_activity.transition_duration;
+        write_controller_state(registry, controller_activity, controller_activity.next_state,
+                               playback_time(controller_activity.next_time, controller_activity.next_ticks), weight);
+        advance(controller_activity.next_time, controller_activity.next_ticks, delta_time, delta_ticks,
+                states[controller_activity.next_state].speed);
+        controller_activity.transition_elapsed += delta_time;
+
+        if (controller_activity.transition_duration <= controller_activity.transition_elapsed) {
+            controller_activity.current_state = controller_activity.next_state;
+            controller_activity.current_time = controller_activity.next_time;
+            controller_activity.current_ticks = controller_activity.next_ticks;
+            controller_activity.next_state = -1;
+        }
+    }
+
+    void write_controller_state(nodec_scene::SceneRegistry &registry,
+                                components::impl::AnimatorControllerActivity &controller_activity,
+                                int state_index, PlaybackTime time, float weight) {
+        const auto &state = controller_activity.description->compiled_states()[state_index];
+        if (state.clip < 0) return;
+
+        prepare_stream(*controller_activity.description->clips()[state.clip], time.seconds);
+
+        const auto begin = controller_activity.binding_offsets[state.clip];
+        const auto end = controller_activity.binding_offsets[state.clip + 1];
+        for (auto i = begin; i < end; ++i) {
+            auto &binding = controller_activity.bindings[i];
+            write_entity(registry, binding.entity, binding.component_animation_states, time, weight);
+        }
+    }
+
+    static void prepare_stream(const resources::AnimationClip &clip, float time) {
+        if (auto *stream = clip.stream()) stream->prepare(time);
+    }
+
+    static std::uint32_t entity_to_id(nodec_scene::SceneEntity entity) noexcept {
+        static_assert(sizeof(nodec_scene::SceneEntity) == sizeof(std::uint32_t)
+                          && std::is_trivially_copyable<nodec_scene::SceneEntity>::value,
+                      "Snapshots store entities as 32-bit ids.");
+        std::uint32_t id;
+        std::memcpy(&id, &entity, sizeof(id));
+        return id;
+    }
+
+    static nodec_scene::SceneEntity id_to_entity(std::uint32_t id) noexcept {
+        nodec_scene::SceneEntity entity;
+        std::memcpy(&entity, &id, sizeof(id));
+        return entity;
+    }
+
+    static components::impl::AnimatedData *find_animated_data(nodec_scene::SceneRegistry &registry,
+                                                              const nodec_scene::SceneEntity &entity) {
+        using namespace components::impl;
+
+        if (auto *animated_data = registry.try_get_component<AnimatedData>(entity)) return animated_data;
+        auto *sleeping_data = registry.try_get_component<SleepingAnimatedData>(entity);
+        return sleeping_data ? &sleeping_data->data : nullptr;
+    }
+
+    /**
+     * @brief Moves the AnimatedData of the entity in or out of sleep, like sleep() and wake_up() do.
+     */
+    static components::impl::AnimatedData *set_sleeping(nodec_scene::SceneRegistry &registry,
+                                                        const nodec_scene::SceneEntity &entity, bool sleeping) {
+        using namespace components::impl;
+
+        if (sleeping) {
+            if (auto *animated_data = registry.try_get_component<AnimatedData>(entity)) {
+                registry.emplace_component<SleepingAnimatedData>(entity).first.data = std::move(*animated_data);
+                registry.remove_component<AnimatedData>(entity);
+            }
+            auto *sleeping_data = registry.try_get_component<SleepingAnimatedData>(entity);
+            return sleeping_data ? &sleeping_data->data : nullptr;
+        }
+
+        if (auto *sleeping_data = registry.try_get_component<SleepingAnimatedData>(entity)) {
+            registry.emplace_component<AnimatedData>(entity).first = std::move(sleeping_data->data);
+            registry.remove_component<SleepingAnimatedData>(entity);
+        }
+        return registry.try_get_component<AnimatedData>(entity);
+    }
+
+    // The states are prepared at bind and never inserted into afterwards,
+    // so they are visited in the same order until the entity is bound again.
+    static std::uint32_t save_hints(const ComponentAnimationStates &states, std::vector<char> &buffer) {
+        std::uint32_t count = 0;
+        for (const auto &component : states) {
+            for (const auto &property : component.second.properties) {
+                serialization::append_snapshot(buffer, static_cast<std::int32_t>(property.second.current_index));
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    static bool restore_hints(ComponentAnimationStates &states, serialization::SnapshotReader &reader,
+                              std::uint32_t &count) {
+        for (auto &component : states) {
+            for (auto &property : component.second.properties) {
+                std::int32_t hint;
+                if (!reader.read(hint)) return false;
+                property.second.current_index = hint;
+                ++count;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the part of the entity tree of the clip the property mask includes,
+     * or nullptr if the clip is not masked.
+     */
+    std::shared_ptr<const MaskedEntityTree> mask(const std::shared_ptr<resources::AnimationClip> &clip) {
+        if (property_mask_.empty()) return nullptr;
+
+        auto iter = masked_clips_.find(clip.get());
+        if (iter != masked_clips_.end() && iter->second.clip.lock() == clip && iter->second.version == clip->version()) {
+            return iter->second.masked_tree;
+        }
+
+        // The trees of clips which have been freed meanwhile are dropped here, when a new one is made.
+        for (auto entry = masked_clips_.begin(); entry != masked_clips_.end();) {
+            entry = entry->second.clip.expired() ? masked_clips_.erase(entry) : std::next(entry);
+        }
+
+        auto masked_tree = std::make_shared<MaskedEntityTree>();
+        property_mask_.apply(clip->root_entity(), *masked_tree);
+        masked_clips_[clip.get()] = {clip, clip->version(), masked_tree};
+        return masked_tree;
+    }
+
+    PlaybackTime playback_time(float time, std::int64_t ticks) const noexcept {
+        return ticks_per_second_ > 0 ? PlaybackTime::from_ticks(ticks, ticks_per_second_) : PlaybackTime(time);
+    }
+
+    /**
+     * @brief Advances a playback time by the delta time, or by the delta ticks in a tick time base.
+     */
+    void advance(float &time, std::int64_t &ticks, float delta_time, std::int64_t delta_ticks, float speed) const noexcept {
+        if (ticks_per_second_ == 0) {
+            time += delta_time * speed;
+            return;
+        }
+        ticks += speed == 1.f ? delta_ticks : static_cast<std::int64_t>(std::llround(delta_ticks * static_cast<double>(speed)));
+        time = static_cast<float>(ticks_to_seconds(ticks, ticks_per_second_));
+    }
+
+    /**
+     * @brief Moves the ticks of a looping activity back into the first loop, together with the time of its events.
+     */
+    void wrap_ticks(components::impl::AnimatorActivity &animator_activity) const noexcept {
+        const auto &clip = *animator_activity.clip;
+        if (!clip.is_looping()) return;
+
+        const auto duration_ticks = seconds_to_ticks(clip.duration(), ticks_per_second_);
+        if (duration_ticks <= 0) return;
+
+        auto loops = animator_activity.ticks / duration_ticks;
+        if (animator_activity.ticks % duration_ticks < 0) --loops;
+        if (loops == 0) return;
+
+        const auto shift = loops * duration_ticks;
+        animator_activity.ticks -= shift;
+        animator_activity.time = static_cast<float>(ticks_to_seconds(animator_activity.ticks, ticks_per_second_));
+        animator_activity.event_time -= static_cast<float>(ticks_to_seconds(shift, ticks_per_second_));
+    }
+
+    static double seconds_since(std::chrono::steady_clock::time_point begin) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    void record_clip_statistics(const resources::AnimationClip *clip, const EvaluationCounters &counters_begin) {
+        const auto &counters = nodec_animation::impl::evaluation_counters();
+        auto &clip_statistics = statistics_.clips[clip];
+        ++clip_statistics.bound_entities;
+        ++statistics_.bound_entities;
+        clip_statistics.curves_evaluated += counters.curves_evaluated - counters_begin.curves_evaluated;
+        clip_statistics.property_writes += counters.property_writes - counters_begin.property_writes;
+    }
+
+    static bool is_finished(const resources::AnimationClip &clip, float time, float speed) {
+        if (clip.is_looping()) return false;
+        return speed < 0.f ? time <= 0.f : clip.duration() <= time;
+    }
+
+    static float start_time(const resources::AnimationClip *clip, float speed) {
+        return clip && speed < 0.f ? clip->duration() : 0.f;
+    }
+
+    void fire_event(const nodec_scene::SceneEntity &entity, const AnimationEvent &event) {
+        fired_events_.push_back({entity, event});
+    }
+
+    /**
+     * @brief Fires the events passed between the last fired time and the current time of the activity.
+     *
+     * Only the events actually passed are visited, starting from the cursor of the activity.
+     * Every loop crossed within the update fires the events of the whole loop.
+     */
+    void fire_events(const nodec_scene::SceneEntity &entity,
+                     components::impl::AnimatorActivity &animator_activity) {
+        const auto &clip = *animator_activity.clip;
+        const auto &events = clip.events();
+
+        const float from = animator_activity.event_time;
+        const float to = animator_activity.time;
+        animator_activity.event_time = to;
+
+        if (events.empty() || !std::isfinite(from) || !std::isfinite(to)) return;
+
+        const float duration = clip.duration();
+        const bool looping = clip.is_looping() && duration > 0.f;
+        auto &cursor = animator_activity.event_cursor;
+
+        // The cursor is set up by the sign of the speed, so that an update without progress
+        // still fires the events at the start time in the direction of playback.
+        const bool forward = from < to || (from == to && animator_activity.speed >= 0.f);
+
+        if (!looping) {
+            const float target = nodec::clamp(to, 0.f, duration);
+            if (forward) {
+                while (cursor < events.size() && events[cursor].time <= target) {
+                    fire_event(entity, events[cursor++]);
+                }
+            } else {
+                while (cursor > 0 && target <= events[cursor - 1].time) {
+                    fire_event(entity, events[--cursor]);
+                }
+            }
+            return;
+        }
+
+        if (forward) {
+            float position = std::fmod(from, duration);
+            if (position < 0.f) position += duration;
+            float remaining = to - from;
+
+            if (duration <= position + remaining) {
+                // Crossing the end of the loop.
+                while (cursor < events.size()) {
+                    fire_event(entity, events[cursor++]);
+                }
+                cursor = 0;
+                remaining -= duration - position;
+                fire_whole_loops(entity, events, remaining, duration);
+                remaining = std::fmod(remaining, duration);
+                position = 0.f;
+            }
+
+            const float target = position + remaining;
+            while (cursor < events.size() && events[cursor].time <= target) {
+                fire_event(entity, events[cursor++]);
+            }
+            return;
+        }
+
+        float position = duration - std::fmod(duration - from, duration);
+        if (duration < position) position -= duration;
+        float remaining = from - to;
+
+        if (position - remaining <= 0.f) {
+            // Crossing the beginning of the loop.
+            while (cursor > 0) {
+                fire_event(entity, events[--cursor]);
+            }
+            cursor = events.size();
+            remaining -= position;
+            fire_whole_loops(entity, events, remaining, duration, true);
+            remaining = std::fmod(remaining, duration);
+            position = duration;
+        }
+
+        const float target = position - remaining;
+        while (cursor > 0 && target <= events[cursor - 1].time) {
+            fire_event(entity, events[--cursor]);
+        }
+    }
+
+    /**
+     * @brief Fires all events once for each whole loop contained in the given time span.
+     */
+    void fire_whole_loops(const nodec_scene::SceneEntity &entity, const std::vector<AnimationEvent> &events,
+                          float span, float duration, bool reverse = false) {
+        const auto loops = (std::min)(std::floor(span / duration), static_cast<float>(max_event_loops_per_update));
+        for (int i = 0; i < static_cast<int>(loops); ++i) {
+            if (reverse) {
+                for (auto iter = events.rbegin(); iter != events.rend(); ++iter) fire_event(entity, *iter);
+            } else {
+                for (const auto &event : events) fire_event(entity, event);
+            }
+        }
+    }
+
+    void sleep(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity) {
+        using namespace components;
+        using namespace components::impl;
+
+        auto &animated_data = registry.get_component<AnimatedData>(entity);
+        auto clip = animated_data.clip();
+
+        registry.emplace_component<SleepingAnimatedData>(entity).first.data = std::move(animated_data);
+        registry.remove_component<AnimatedData>(entity);
+
+        // The animator entity itself is always bound to the root of its clip,
+        // so its data finishing means that the whole activity has finished.
+        auto *animator_activity = registry.try_get_component<AnimatorActivity>(entity);
+        if (!animator_activity || animator_activity->clip != clip) return;
+
+        animator_activity->sleeping = true;
+        registry.emplace_component<AnimatorFinished>(entity);
+    }
+
+    void wake_up(nodec_scene::SceneRegistry &registry,
+                 components::impl::AnimatorActivity &animator_activity) {
+        using namespace components::impl;
+
+        if (!animator_activity.sleeping) return;
+
+        for (auto &entity : animator_activity.animated_entities) {
+            auto *sleeping_data = registry.try_get_component<SleepingAnimatedData>(entity);
+            if (!sleeping_data) continue;
+
+            registry.emplace_component<AnimatedData>(entity).first = std::move(sleeping_data->data);
+            registry.remove_component<SleepingAnimatedData>(entity);
+        }
+        animator_activity.sleeping = false;
+    }
+
+    void unbind(nodec_scene::SceneRegistry &registry,
+                components::impl::AnimatorActivity &animator_activity) {
+        using namespace components::impl;
+
+        // The data are pooled in reverse, so that binding the same clip again
+        // pops them in bind order and finds its animation states prepared.
+        auto &entities = animator_activity.animated_entities;
+        for (auto iter = entities.rbegin(); iter != entities.rend(); ++iter) {
+            if (max_pooled_animated_data <= animated_data_pool_.size()) break;
+
+            auto *animated_data = registry.try_get_component<AnimatedData>(*iter);
+            if (!animated_data) {
+                auto *sleeping_data = registry.try_get_component<SleepingAnimatedData>(*iter);
+                if (!sleeping_data) continue;
+                animated_data = &sleeping_data->data;
+            }
+            animated_data->release();
+            animated_data_pool_.push_back(std::move(*animated_data));
+        }
+
+        registry.remove_component<AnimatedData>(animator_activity.animated_entities.begin(),
+                                                animator_activity.animated_entities.end());
+        registry.remove_component<SleepingAnimatedData>(animator_activity.animated_entities.begin(),
+                                                        animator_activity.animated_entities.end());
+        animator_activity.animated_entities.clear();
+        animator_activity.sleeping = false;
+    }
+
     void reset_animation_time(nodec_scene::SceneRegistry &registry,
+                              const components::Animator &animator,
                               components::impl::AnimatorActivity &animator_activity) {
         using namespace nodec_scene;
         using namespace components;
         using namespace components::impl;
 
+        const auto time = start_time(animator_activity.clip.get(), animator.speed);
+        const auto ticks = ticks_per_second_ > 0 ? seconds_to_ticks(time, ticks_per_second_) : 0;
+
         for (auto &entity : animator_activity.animated_entities) {
             auto animated_data = registry.try_get_component<AnimatedData>(entity);
             if (!animated_data) continue;
-            animated_data->time = 0.f;
+            animated_data->time = time;
+            animated_data->ticks = ticks;
+            animated_data->speed = animator.speed;
         }
+
+        animator_activity.time = time;
+        animator_activity.ticks = ticks;
+        animator_activity.speed = animator.speed;
+        animator_activity.event_time = time;
+        animator_activity.event_cursor = animator.speed < 0.f && animator_activity.clip
+                                             ? animator_activity.clip->events().size()
+                                             : 0;
     }
 
-    void bind(components::Animator &animator, nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
-              components::impl::AnimatorActivity &animator_activity) {
+    /**
+     * @brief Sets the animator up for binding, which bind_prepared() then does for all started animators at once.
+     */
+    void prepare_bind(components::Animator &animator, const nodec_scene::SceneEntity &entity,
+                      components::impl::AnimatorActivity &animator_activity) {
+        animator_activity.clip = animator.clip;
+
+        if (bind_job_count_ == bind_jobs_.size()) bind_jobs_.emplace_back();
+        auto &job = bind_jobs_[bind_job_count_++];
+        job.entity = entity;
+        job.root = nullptr;
+        job.masked_tree.reset();
+        job.bindings.clear();
+
         if (!animator.clip) return;
+        if (ticks_per_second_ > 0) animator.clip->prepare_ticks(ticks_per_second_);
 
-        bind_each(registry, entity, animator.clip->root_entity(), animator.clip, animator_activity);
+        animator_activity.clip_version = animator.clip->version();
+        job.root = &animator.clip->root_entity();
+        job.masked_tree = mask(animator.clip);
     }
 
-    void bind_each(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity, const resources::AnimatedEntity &animated_entity,
-                   std::shared_ptr<resources::AnimationClip> &clip,
-                   components::impl::AnimatorActivity &animator_activity) {
-        using namespace nodec::entities;
-        using namespace nodec_scene::components;
-        using namespace nodec_animation::components::impl;
+    /**
+     * @brief Binds the prepared animators in two phases.
+     *
+     * The entities each animator binds are resolved first, only reading the registry, which the executor may do
+     * in parallel across the animators. The AnimatedData are then created in one pass on the calling thread.
+     */
+    void bind_prepared(nodec_scene::SceneRegistry &registry) {
+        using namespace components;
+        using namespace components::impl;
+
+        if (bind_job_count_ == 0) return;
+        ScopedTraceZone zone(tracer_, "bind");
 
+        auto resolve_job = [&](std::size_t index) {
+            auto &job = bind_jobs_[index];
+            if (job.root) resolve(registry, job.entity, *job.root, job.masked_tree.get(), job.bindings);
+        };
         {
-            auto &animated_data = registry.emplace_component<AnimatedData>(entity).first;
-            animated_data.reset(clip, &animated_entity);
+            ScopedTraceZone resolve_zone(tracer_, "resolve");
+            if (executor_ && min_parallel_bind_jobs <= bind_job_count_) {
+                // The registry may create a component pool on its first lookup. The pools the resolve reads are
+                // looked up once here, so that the threads below only read the registry.
+                registry.try_get_component<nodec_scene::components::Hierarchy>(bind_jobs_[0].entity);
+                registry.try_get_component<nodec_scene::components::Name>(bind_jobs_[0].entity);
+                executor_->run(bind_job_count_, resolve_job);
+            } else {
+                for (std::size_t i = 0; i < bind_job_count_; ++i) resolve_job(i);
+            }
+        }
+
+        ScopedTraceZone commit_zone(tracer_, "commit");
+        for (std::size_t i = 0; i < bind_job_count_; ++i) {
+            auto &job = bind_jobs_[i];
+            auto &animator = registry.get_component<Animator>(job.entity);
+            auto &animator_activity = registry.get_component<AnimatorActivity>(job.entity);
+
+            commit(registry, job.bindings, animator_activity.clip, animator_activity);
+            reset_animation_time(registry, animator, animator_activity);
+            job.masked_tree.reset();
         }
+        bind_job_count_ = 0;
+    }
+
+    /**
+     * @brief Collects the scene entities animated by the entity tree in depth-first order.
+     *
+     * Only reads the registry, so it may run on several threads as long as nothing writes to the registry.
+     */
+    static void resolve(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+                        const resources::AnimatedEntity &animated_entity, const MaskedEntityTree *masked_tree,
+                        std::vector<ResolvedBinding> &bindings) {
+        auto push = [&](const nodec_scene::SceneEntity &bound_entity,
+                        const resources::AnimatedEntity &bound_animated_entity,
+                        const MaskedEntityTree::IncludedEntity *included) {
+            bindings.push_back({bound_entity, &bound_animated_entity, included});
+        };
+        for_each_bound(registry, entity, animated_entity, masked_tree, push);
+    }
 
-        animator_activity.animated_entities.push_back(entity);
+    /**
+     * @brief Calls the function with each scene entity the entity tree animates, its animated entity and
+     * the properties the masked tree includes, in depth-first order. Children are matched by name.
+     *
+     * With a masked tree, the entities it leaves out are skipped.
+     */
+    template<class Function>
+    static void for_each_bound(nodec_scene::SceneRegistry &registry, const nodec_scene::SceneEntity &entity,
+                               const resources::AnimatedEntity &animated_entity, const MaskedEntityTree *masked_tree,
+                               Function &function) {
+        using namespace nodec::entities;
+        using namespace nodec_scene::components;
 
-        auto &hierarchy = registry.emplace_component<Hierarchy>(entity).first;
+        const auto *included = masked_tree ? masked_tree->find(animated_entity) : nullptr;
+        if (masked_tree && !included) return;
+        function(entity, animated_entity, included);
 
-        auto child_entity = hierarchy.first;
+        auto *hierarchy = registry.try_get_component<Hierarchy>(entity);
+        if (!hierarchy) return;
+
+        auto child_entity = hierarchy->first;
         while (child_entity != null_entity) {
-            auto &child_hierarchy = registry.emplace_component<Hierarchy>(child_entity).first;
+            auto *child_hierarchy = registry.try_get_component<Hierarchy>(child_entity);
             auto child_name = registry.try_get_component<Name>(child_entity);
-            if (!child_name) {
-                child_entity = child_hierarchy.next;
-                continue;
+            if (child_name) {
+                auto iter = animated_entity.children.find(child_name->value);
+                if (iter != animated_entity.children.end()) {
+                    for_each_bound(registry, child_entity, iter->second, masked_tree, function);
+                }
             }
+            if (!child_hierarchy) break;
+            child_entity = child_hierarchy->next;
+        }
+    }
 
-            auto iter = animated_entity.children.find(child_name->value);
-            if (iter == animated_entity.children.end()) {
-                child_entity = child_hierarchy.next;
+    /**
+     * @brief Creates the AnimatedData of the resolved entities, or remaps the data they already have for the clip.
+     */
+    void commit(nodec_scene::SceneRegistry &registry, const std::vector<ResolvedBinding> &bindings,
+                std::shared_ptr<resources::AnimationClip> &clip,
+                components::impl::AnimatorActivity &animator_activity,
+                const RemapTiming *remap_timing = nullptr) {
+        using namespace nodec_animation::components::impl;
+
+        for (const auto &binding : bindings) {
+            const auto &entity = binding.entity;
+            animator_activity.animated_entities.push_back(entity);
+
+            auto *remapped_data = remap_timing ? find_animated_data(registry, entity) : nullptr;
+            if (remapped_data && remapped_data->clip() == clip) {
+                remapped_data->remap(binding.animated_entity, binding.included);
                 continue;
             }
 
-            bind_each(registry, child_entity, iter->second, clip, animator_activity);
+            auto result = registry.emplace_component<AnimatedData>(entity);
+            auto &animated_data = result.first;
+            if (result.second && !animated_data_pool_.empty()) {
+                animated_data = std::move(animated_data_pool_.back());
+                animated_data_pool_.pop_back();
+            }
+            animated_data.reset(clip, binding.animated_entity, binding.included);
+            if (evaluation_order_ == EvaluationOrder::clip_hierarchy) add_to_evaluation_order(entity, clip.get());
 
-            child_entity = child_hierarchy.next;
+            if (remap_timing) {
+                animated_data.time = remap_timing->time;
+                animated_data.ticks = remap_timing->ticks;
+                animated_data.speed = remap_timing->speed;
+            }
         }
     }
 
 private:
     ComponentRegistry &component_registry_;
+    AnimatedComponentWriter writer_;
+    std::vector<components::impl::AnimatedData> animated_data_pool_;
+    std::vector<std::vector<nodec_scene::SceneEntity>> entity_list_pool_;
+    std::vector<nodec_scene::SceneEntity> started_entities_;
+    std::vector<nodec_scene::SceneEntity> finished_entities_;
+    std::vector<FiredAnimationEvent> fired_events_;
+    AnimatorStatistics statistics_;
+    Tracer *tracer_{nullptr};
+    std::uint32_t ticks_per_second_{0};
+
+    struct MaskedClip {
+        std::weak_ptr<resources::AnimationClip> clip;
+        std::uint32_t version;
+        std::shared_ptr<const MaskedEntityTree> masked_tree;
+    };
+
+    struct EvaluationGroup {
+        const resources::AnimationClip *clip;
+        std::vector<nodec_scene::SceneEntity> entities;
+    };
+
+    EvaluationOrder evaluation_order_{EvaluationOrder::clip_hierarchy};
+    std::vector<EvaluationGroup> evaluation_groups_;
+    std::unordered_map<const resources::AnimationClip *, std::size_t> evaluation_group_indices_;
+    std::uint32_t evaluation_stamp_{0};
+    bool evaluation_order_outdated_{false};
+
+    AnimatorCommandQueue command_queue_;
+    std::vector<CoalescedAnimatorCommand> commands_;
+    // Seeks and speeds of animators waiting for their clip, applied once the animator has started.
+    std::vector<CoalescedAnimatorCommand> deferred_commands_;
+
+    ParallelExecutor *executor_{nullptr};
+
+    // Kept with their binding lists across updates, of which the first bind_job_count_ are in use.
+    std::vector<BindJob> bind_jobs_;
+    std::size_t bind_job_count_{0};
+
+    std::vector<nodec_scene::SceneEntity> stale_entities_;
+    std::vector<nodec_scene::SceneEntity> remapped_entities_;
+    std::vector<ResolvedBinding> remapped_bindings_;
+    std::size_t remap_budget_{0};
+
+    PropertyMask property_mask_;
+    std::unordered_map<const resources::AnimationClip *, MaskedClip> masked_clips_;
 };
 } // namespace systems
 } // namespace nodec_animation
@@ -0,0 +1,222 @@
+#ifndef NODEC_ANIMATION__TRACING_HPP_
+#define NODEC_ANIMATION__TRACING_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace nodec_animation {
+
+/**
+ * @brief Interface receiving the trace zones of the animation systems.
+ *
+ * Zone names must outlive the tracer; string literals are expected.
+ */
+class Tracer {
+public:
+    virtual ~Tracer() {}
+
+    virtual void begin_zone(const char *name) = 0;
+    virtual void end_zone(const char *name) = 0;
+};
+
+/**
+ * @brief Opens a zone on construction and closes it on destruction. Does nothing without a tracer.
+ */
+class ScopedTraceZone {
+public:
+    ScopedTraceZone(Tracer *tracer, const char *name)
+        : tracer_(tracer), name_(name) {
+        if (tracer_) tracer_->begin_zone(name_);
+    }
+
+    ~ScopedTraceZone() {
+        if (tracer_) tracer_->end_zone(name_);
+    }
+
+    ScopedTraceZone(const ScopedTraceZone &) = delete;
+    ScopedTraceZone &operator=(const ScopedTraceZone &) = delete;
+
+private:
+    Tracer *tracer_;
+    const char *name_;
+};
+
+/**
+ * @brief Tracer recording zones into a fixed-size lock-free ring buffer.
+ *
+ * Recording never allocates or blocks, and may happen from several threads.
+ * When the buffer is full the oldest events are overwritten.
+ * The recorded events can be written as Chrome trace-event JSON,
+ * which can be opened with chrome://tracing or https://ui.perfetto.dev.
+ */
+class RingBufferTracer : public Tracer {
+public:
+    struct Event {
+        const char *name;
+        std::uint64_t timestamp_ns;
+        std::uint32_t thread;
+        char phase;
+    };
+
+    /**
+     * @param capacity The number of events to keep. Rounded up to a power of two.
+     */
+    explicit RingBufferTracer(std::size_t capacity = 1 << 16)
+        : origin_(std::chrono::steady_clock::now()) {
+        std::size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        mask_ = rounded - 1;
+        slots_.reset(new Slot[rounded]);
+    }
+
+    void begin_zone(const char *name) override {
+        record(name, 'B');
+    }
+
+    void end_zone(const char *name) override {
+        record(name, 'E');
+    }
+
+    /**
+     * @brief Returns the number of events recorded since the last clear, including overwritten ones.
+     */
+    std::uint64_t recorded_count() const noexcept {
+        return next_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Forgets all recorded events. Must not race with recording.
+     */
+    void clear() noexcept {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(0, std::memory_order_relaxed);
+        }
+        next_.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @brief Calls the function with each event still in the buffer, oldest first.
+     *
+     * Events being overwritten while visiting are skipped.
+     */
+    template<class Function>
+    void each(Function &&function) const {
+        const auto end = next_.load(std::memory_order_acquire);
+        const auto begin = end > capacity() ? end - capacity() : 0;
+
+        for (auto index = begin; index < end; ++index) {
+            const auto &slot = slots_[index & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) continue;
+
+            Event event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+            event.thread = slot.thread.load(std::memory_order_relaxed);
+            event.phase = slot.phase.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != index + 1) continue;
+
+            function(event);
+        }
+    }
+
+    void write_chrome_trace(std::ostream &out) const {
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        each([&](const Event &event) {
+            if (!first) out << ',';
+            first = false;
+
+            out << "\n{\"name\":\"";
+            write_escaped(out, event.name);
+            out << "\",\"cat\":\"nodec_animation\",\"ph\":\"" << event.phase
+                << "\",\"ts\":" << event.timestamp_ns / 1000 << '.'
+                << static_cast<char>('0' + (event.timestamp_ns / 100) % 10)
+                << ",\"pid\":1,\"tid\":" << event.thread << '}';
+        });
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    /**
+     * @return false if the file could not be written.
+     */
+    bool write_chrome_trace(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        write_chrome_trace(out);
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct Slot {
+        /**
+         * @brief One past the index of the event stored in this slot, or 0 while it is written.
+         */
+        std::atomic<std::uint64_t> sequence{0};
+
+        // The fields are atomics only to make concurrent overwrites well-defined;
+        // relaxed accesses compile to plain loads and stores.
+        std::atomic<const char *> name{nullptr};
+        std::atomic<std::uint64_t> timestamp_ns{0};
+        std::atomic<std::uint32_t> thread{0};
+        std::atomic<char> phase{0};
+    };
+
+    void record(const char *name, char phase) noexcept {
+        const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+        auto &slot = slots_[index & mask_];
+
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.timestamp_ns.store(static_cast<std::uint64_t>(
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin_).count()),
+                                std::memory_order_relaxed);
+        slot.thread.store(current_thread_id(), std::memory_order_relaxed);
+        slot.phase.store(phase, std::memory_order_relaxed);
+
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    static std::uint32_t current_thread_id() noexcept {
+        thread_local const std::uint32_t id = static_cast<std::uint32_t>(
+            std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return id;
+    }
+
+    static void write_escaped(std::ostream &out, const char *text) {
+        for (; *text; ++text) {
+            const char c = *text;
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            } else {
+                out << c;
+            }
+        }
+    }
+
+private:
+    std::chrono::steady_clock::time_point origin_;
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t mask_;
+    std::atomic<std::uint64_t> next_{0};
+};
+
+} // namespace nodec_animation
+
+#endif
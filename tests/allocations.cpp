@@ -0,0 +1,252 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_scene/scene.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+std::size_t allocation_count = 0;
+} // namespace
+
+void *operator new(std::size_t size) {
+    ++allocation_count;
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+struct TestComponent {
+    float value{0.f};
+
+    struct Nested {
+        float x{0.f};
+        float y{0.f};
+
+        template<class Archive>
+        void serialize(Archive &archive) {
+            archive(cereal::make_nvp("x", x), cereal::make_nvp("y", y));
+        }
+    } nested;
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("value", value), cereal::make_nvp("nested", nested));
+    }
+};
+
+TEST_CASE("Testing that the steady state of AnimatorSystem does not allocate") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto make_clip = [](float scale) {
+        auto clip = std::make_shared<AnimationClip>();
+        AnimationCurve curve;
+        for (int i = 0; i <= 8; ++i) {
+            curve.add_keyframe({i * 0.25f, scale * static_cast<float>(i % 3)});
+        }
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("", "nested.x", curve);
+        clip->set_curve<TestComponent>("child", "nested.y", curve);
+        clip->add_event({0.5f, 1});
+        clip->add_event({1.5f, 2});
+        return clip;
+    };
+
+    auto clip = make_clip(1.f);
+
+    auto description = std::make_shared<AnimatorDescription>();
+    const auto toggle = description->add_parameter("toggle", AnimatorParameterType::Trigger);
+    const auto a_state = description->add_state("a", make_clip(1.f));
+    const auto b_state = description->add_state("b", make_clip(2.f));
+    description->add_condition(description->add_transition(a_state, b_state, 0.2f), toggle, AnimatorConditionMode::If);
+    description->add_condition(description->add_transition(b_state, a_state, 0.2f), toggle, AnimatorConditionMode::If);
+    description->set_default_state(a_state);
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto make_hierarchy = [&]() {
+        auto root = scene.create_entity("root");
+        auto child = scene.create_entity("child");
+        scene.hierarchy_system().append_child(root, child);
+        registry.emplace_component<TestComponent>(root);
+        registry.emplace_component<TestComponent>(child);
+        return root;
+    };
+
+    for (int i = 0; i < 8; ++i) {
+        auto entity = make_hierarchy();
+        registry.emplace_component<Animator>(entity).first.clip = clip;
+        registry.emplace_component<AnimatorStart>(entity);
+    }
+
+    auto controller_entity = make_hierarchy();
+    registry.emplace_component<AnimatorController>(controller_entity).first.description = description;
+    registry.emplace_component<AnimatorStart>(controller_entity);
+
+    auto run_frames = [&](int frames) {
+        for (int frame = 0; frame < frames; ++frame) {
+            if (frame % 10 == 0) {
+                registry.get_component<AnimatorController>(controller_entity).set_trigger(toggle);
+            }
+            animator_system.update(registry, 1.f / 60.f);
+        }
+    };
+
+    // Warm-up: binding and growth of the reused buffers.
+    animator_system.update(registry, 1.f / 60.f);
+    run_frames(240);
+
+    const auto allocations_before = allocation_count;
+    run_frames(600);
+    const auto allocations = allocation_count - allocations_before;
+
+    CHECK(allocations == 0);
+}
+
+TEST_CASE("Testing that stopping and restarting animators reuses pooled state") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("child", "nested.x", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    std::vector<SceneEntity> roots;
+    for (int i = 0; i < 8; ++i) {
+        auto root = scene.create_entity("root");
+        auto child = scene.create_entity("child");
+        scene.hierarchy_system().append_child(root, child);
+        registry.emplace_component<TestComponent>(root);
+        registry.emplace_component<TestComponent>(child);
+        registry.emplace_component<Animator>(root).first.clip = clip;
+        registry.emplace_component<AnimatorStart>(root);
+        roots.push_back(root);
+    }
+
+    auto run_frames = [&](int frames) {
+        for (int frame = 0; frame < frames; ++frame) {
+            // Half of the animators are stopped in one frame and restarted in the next.
+            for (std::size_t i = 0; i < roots.size(); i += 2) {
+                if (frame % 2 == 0) {
+                    registry.emplace_component<AnimatorStop>(roots[i]);
+                } else {
+                    registry.emplace_component<AnimatorStart>(roots[i]);
+                }
+            }
+            animator_system.update(registry, 1.f / 60.f);
+        }
+    };
+
+    animator_system.update(registry, 1.f / 60.f);
+    run_frames(20);
+
+    const auto allocations_before = allocation_count;
+    run_frames(200);
+    const auto allocations = allocation_count - allocations_before;
+
+    CHECK(allocations == 0);
+}
+
+TEST_CASE("Testing that commands pushed in the steady state do not allocate") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    std::vector<SceneEntity> roots;
+    for (int i = 0; i < 8; ++i) {
+        auto root = scene.create_entity("root");
+        registry.emplace_component<TestComponent>(root);
+        registry.emplace_component<Animator>(root).first.clip = clip;
+        registry.emplace_component<AnimatorStart>(root);
+        roots.push_back(root);
+    }
+
+    auto &commands = animator_system.command_queue();
+    auto run_frames = [&](int frames) {
+        for (int frame = 0; frame < frames; ++frame) {
+            for (auto &root : roots) {
+                commands.seek(root, 0.25f * static_cast<float>(frame % 4));
+                commands.set_speed(root, frame % 2 == 0 ? 1.f : 2.f);
+            }
+            animator_system.update(registry, 1.f / 60.f);
+        }
+    };
+
+    animator_system.update(registry, 1.f / 60.f);
+    run_frames(20);
+
+    const auto allocations_before = allocation_count;
+    run_frames(200);
+    const auto allocations = allocation_count - allocations_before;
+
+    CHECK(allocations == 0);
+}
@@ -90,5 +90,23 @@ TEST_CASE("Testing to write properties to a component") {
         CHECK(test_component.position.z == 3.f);
         CHECK(test_component.field == 1.f);
         CHECK(test_component.resource == test_resource);
+
+        SUBCASE("a state which has not been bound gets the hints of the written properties") {
+            AnimatedComponentWriter::ComponentAnimationState state;
+            writer.write(animated_component, 250, test_component, &state);
+
+            CHECK(math::approx_equal(test_component.position.x, 0.25f));
+            REQUIRE(state.properties.count("position.x") == 1);
+            CHECK(state.properties["position.x"].current_index == 0);
+        }
+
+        SUBCASE("a bound state writes only its properties") {
+            AnimatedComponentWriter::ComponentAnimationState state;
+            std::vector<const AnimatedComponent::PropertyMap::value_type *> none;
+            state.bind(animated_component, none);
+            writer.write(animated_component, 250, test_component, &state);
+
+            CHECK(math::approx_equal(test_component.position.x, 0.5f));
+        }
     }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <vector>
 
+#include <cereal/archives/binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <nodec/ranges.hpp>
 #include <nodec_animation/resources/animation_clip.hpp>
@@ -44,6 +45,72 @@ TEST_CASE("Testing set_curve") {
     }
 }
 
+TEST_CASE("Testing clips built into an arena") {
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation;
+
+    auto arena = std::make_shared<MonotonicArena>();
+
+    AnimationCurve curve;
+    curve.add_keyframe({0.f, 0.f});
+    curve.add_keyframe({1.f, 1.f});
+
+    AnimationClip clip(arena);
+    clip.set_curve<ComponentA>("", "prop", curve);
+    clip.set_curve<ComponentA>("a/b", "prop", curve);
+    CHECK(clip.arena() == arena.get());
+    CHECK(arena->allocated_bytes() > 0);
+
+    const auto &curve_in_arena = clip.root_entity().children.at("a").children.at("b").components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+    CHECK(curve_in_arena.get_allocator().arena() == arena.get());
+    CHECK(curve_in_arena.keyframes().size() == 2);
+
+    SUBCASE("copies do not depend on the arena") {
+        AnimatedEntity copy = clip.root_entity();
+        CHECK(copy.components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve.get_allocator().arena() == nullptr);
+    }
+
+    SUBCASE("a heap entity moved into the clip is moved into the arena") {
+        AnimationClip heap_clip;
+        heap_clip.set_curve<ComponentB>("c", "prop", curve);
+
+        AnimatedEntity entity = heap_clip.root_entity();
+        clip.set_root_entity(std::move(entity));
+        CHECK(clip.root_entity().children.at("c").components.at(nodec::type_id<ComponentB>()).properties.at("prop").curve.get_allocator().arena() == arena.get());
+        CHECK(clip.duration() == 1.f);
+    }
+}
+
+TEST_CASE("Testing to prepare clips for ticks") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    AnimationClip clip;
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        clip.set_curve<ComponentA>("", "prop", curve);
+    }
+
+    CHECK(!clip.is_prepared_for_ticks(60000));
+    clip.prepare_ticks(60000);
+    CHECK(clip.is_prepared_for_ticks(60000));
+    CHECK(!clip.is_prepared_for_ticks(48000));
+
+    // Changing the clip or its curves drops the preparation.
+    clip.find_curve("", nodec::type_id<ComponentA>(), "prop")->add_keyframe({2.f, 0.f});
+    CHECK(!clip.is_prepared_for_ticks(60000));
+
+    clip.prepare_ticks(60000);
+    clip.set_curve<ComponentA>("a", "prop", AnimationCurve());
+    CHECK(!clip.is_prepared_for_ticks(60000));
+
+    clip.prepare_ticks(60000);
+    clip.update_curves([](AnimationCurve &) {});
+    CHECK(!clip.is_prepared_for_ticks(60000));
+}
+
 struct SerializableComponentA : public nodec_scene_serialization::BaseSerializableComponent {
     int prop{0};
 
@@ -130,4 +197,38 @@ TEST_CASE("Testing serialization") {
         CHECK(clip.root_entity().children.at("a").components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve.keyframes().size() == 2);
         CHECK(clip.root_entity().children.at("b").children.at("a").components.at(nodec::type_id<SerializableComponentC>()).properties.at("prop").curve.keyframes().size() == 3);
     }
+
+    SUBCASE("binary archives keep the events") {
+        clip.add_event({0.25f, 7});
+
+        std::stringstream binary(std::ios::in | std::ios::out | std::ios::binary);
+        {
+            ArchiveContext context{serialization, resource_registry};
+            cereal::UserDataAdapter<ArchiveContext, cereal::BinaryOutputArchive> archive(context, binary);
+            archive(clip);
+        }
+        ArchiveContext context{serialization, resource_registry};
+        cereal::UserDataAdapter<ArchiveContext, cereal::BinaryInputArchive> archive(context, binary);
+        AnimationClip loaded;
+        archive(loaded);
+        REQUIRE(loaded.events().size() == 1);
+        CHECK(loaded.events()[0].id == 7);
+        CHECK(loaded.root_entity().children.at("a").components.size() == 1);
+    }
+
+    SUBCASE("binary archives of version 0 have no events") {
+        std::stringstream binary(std::ios::in | std::ios::out | std::ios::binary);
+        {
+            ArchiveContext context{serialization, resource_registry};
+            cereal::UserDataAdapter<ArchiveContext, cereal::BinaryOutputArchive> archive(context, binary);
+            // The class version, followed by the root entity and nothing else.
+            archive(std::uint32_t{0}, clip.root_entity());
+        }
+        ArchiveContext context{serialization, resource_registry};
+        cereal::UserDataAdapter<ArchiveContext, cereal::BinaryInputArchive> archive(context, binary);
+        AnimationClip loaded;
+        archive(loaded);
+        CHECK(loaded.events().empty());
+        CHECK(loaded.root_entity().children.at("a").components.size() == 1);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <string>
+
+#include <nodec_animation/resources/animation_clip_builder.hpp>
+
+struct ComponentA {
+    float prop;
+};
+struct ComponentB {
+    float prop;
+};
+
+TEST_CASE("Testing clip builder") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    auto make_curve = [](float value) {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, value});
+        curve.add_keyframe({value, value});
+        return curve;
+    };
+
+    const char *paths[] = {"", "a", "a/b", "a/b/c", "a/b", "a/bc", "b", "a/b/c", "a", "/", "b/a"};
+
+    AnimationClipBuilder builder;
+    AnimationClip expected;
+    float value = 1.f;
+    for (const auto *path : paths) {
+        builder.add_curve<ComponentA>(path, "prop", make_curve(value));
+        builder.add_curve<ComponentB>(path, "prop", make_curve(value + 0.5f));
+        expected.set_curve<ComponentA>(path, "prop", make_curve(value));
+        expected.set_curve<ComponentB>(path, "prop", make_curve(value + 0.5f));
+        value += 1.f;
+    }
+    builder.add_curve<ComponentA>("c", "", AnimationCurve());
+    expected.set_curve<ComponentA>("c", "", AnimationCurve());
+    builder.add_event({3.f, 2});
+    builder.add_event({1.f, 1});
+    CHECK(builder.curve_count() == 22);
+
+    auto clip = builder.build();
+    REQUIRE(clip);
+    CHECK(builder.curve_count() == 0);
+
+    SUBCASE("the clip equals one built by set_curve") {
+        CHECK(clip->duration() == expected.duration());
+        REQUIRE(clip->events().size() == 2);
+        CHECK(clip->events()[0].id == 1);
+
+        for (const auto *path : paths) {
+            for (const auto &type : {nodec::type_id<ComponentA>(), nodec::type_id<ComponentB>()}) {
+                const auto *curve = clip->find_curve(path, type, "prop");
+                const auto *expected_curve = expected.find_curve(path, type, "prop");
+                REQUIRE(curve);
+                REQUIRE(expected_curve);
+                CHECK(curve->keyframes().back().value == expected_curve->keyframes().back().value);
+            }
+        }
+        CHECK(clip->root_entity().children.size() == expected.root_entity().children.size());
+        CHECK(clip->root_entity().children.count("c") == 1);
+        CHECK(clip->root_entity().children.at("a").children.size() == 2);
+    }
+
+    SUBCASE("the builder is reusable") {
+        builder.add_curve<ComponentA>("a/b", "prop", make_curve(1.f));
+        auto other = builder.build();
+        CHECK(other->root_entity().children.size() == 1);
+        CHECK(other->find_curve("a/b", nodec::type_id<ComponentA>(), "prop"));
+        CHECK(!other->find_curve("a/b/c", nodec::type_id<ComponentA>(), "prop"));
+    }
+
+    SUBCASE("into an arena") {
+        auto arena = std::make_shared<MonotonicArena>();
+        AnimationClipBuilder arena_builder(arena);
+        arena_builder.add_curve<ComponentA>("a/b", "prop", make_curve(2.f));
+        const auto bytes = arena->allocated_bytes();
+        CHECK(0 < bytes);
+
+        auto arena_clip = arena_builder.build();
+        CHECK(arena_clip->arena() == arena.get());
+        // The tree has been moved, not copied.
+        CHECK(arena->allocated_bytes() == bytes);
+        CHECK(arena_clip->find_curve("a/b", nodec::type_id<ComponentA>(), "prop")->get_allocator().arena() == arena.get());
+        CHECK(arena_clip->duration() == 2.f);
+    }
+}
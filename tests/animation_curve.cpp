@@ -27,6 +27,80 @@ TEST_CASE("Testing add_keyframe()") {
     CHECK(curve.keyframes()[2].time == 1.f);
 }
 
+TEST_CASE("Testing to compare and copy keyframes") {
+    using namespace nodec_animation;
+
+    AnimationCurve curve;
+    for (int i = 0; i < 8; ++i) curve.add_keyframe({i * 0.5f, static_cast<float>(i)});
+
+    AnimationCurve copied = curve;
+    CHECK(copied.keyframes() == curve.keyframes());
+
+    const auto keyframes = static_cast<std::vector<Keyframe>>(curve.keyframes());
+    CHECK(keyframes.size() == 8);
+    CHECK(curve.keyframes() == keyframes);
+    CHECK(keyframes == std::vector<Keyframe>(curve.keyframes()));
+
+    copied.add_keyframe({4.f, 8.f});
+    CHECK(copied.keyframes() != curve.keyframes());
+
+    AnimationCurve changed;
+    for (int i = 0; i < 8; ++i) changed.add_keyframe({i * 0.5f, i == 3 ? 0.f : static_cast<float>(i)});
+    CHECK(changed.keyframes() != curve.keyframes());
+}
+
+TEST_CASE("Testing inline keyframe storage") {
+    using namespace nodec_animation;
+
+    auto arena = std::make_shared<MonotonicArena>();
+    AnimationCurve curve{AnimationCurve::allocator_type(arena.get())};
+
+    for (std::size_t i = 0; i < AnimationCurve::inline_capacity; ++i) {
+        curve.add_keyframe({static_cast<float>(AnimationCurve::inline_capacity - i), static_cast<float>(i)});
+    }
+    CHECK(arena->allocated_bytes() == 0);
+    CHECK(curve.keyframes().size() == AnimationCurve::inline_capacity);
+    CHECK(curve.keyframes().front().time == 1.f);
+
+    SUBCASE("copies and moves keep the keyframes") {
+        AnimationCurve copy = curve;
+        AnimationCurve moved = std::move(copy);
+        CHECK(moved.keyframes().size() == AnimationCurve::inline_capacity);
+        CHECK(moved.keyframes().data() != curve.keyframes().data());
+        CHECK(moved.keyframes().back().time == curve.keyframes().back().time);
+    }
+
+    SUBCASE("longer curves spill into the allocator") {
+        curve.add_keyframe({0.5f, 10.f});
+        CHECK(arena->allocated_bytes() > 0);
+        CHECK(curve.keyframes().size() == AnimationCurve::inline_capacity + 1);
+        CHECK(curve.keyframes().front().value == 10.f);
+        CHECK(curve.evaluate(1.f).second == static_cast<float>(AnimationCurve::inline_capacity - 1));
+
+        std::vector<Keyframe> keyframes{{0.f, 1.f}, {1.f, 3.f}};
+        curve.set_keyframes(std::move(keyframes));
+        CHECK(curve.keyframes().size() == 2);
+        CHECK(curve.evaluate(0.5f).second == 2.f);
+    }
+
+    SUBCASE("one and two keys are evaluated without searching") {
+        AnimationCurve constant;
+        constant.add_keyframe({0.f, 5.f});
+        constant.set_wrap_mode(WrapMode::Loop);
+        CHECK(constant.evaluate(3.f) == std::make_pair(0, 5.f));
+
+        AnimationCurve segment;
+        segment.add_keyframe({1.f, 0.f});
+        segment.add_keyframe({2.f, 4.f});
+        CHECK(segment.evaluate(0.f) == std::make_pair(0, 0.f));
+        CHECK(segment.evaluate(1.5f) == std::make_pair(0, 2.f));
+        CHECK(segment.evaluate(2.f) == std::make_pair(1, 4.f));
+
+        segment.set_wrap_mode(WrapMode::Loop);
+        CHECK(segment.evaluate(3.25f) == std::make_pair(0, 1.f));
+    }
+}
+
 TEST_CASE("Testing evaluate()") {
     using namespace nodec_animation;
     using namespace nodec::math;
@@ -133,6 +207,51 @@ TEST_CASE("Testing evaluate()") {
     }
 }
 
+TEST_CASE("Testing evaluate_ticks()") {
+    using namespace nodec_animation;
+
+    const std::uint32_t ticks_per_second = 48000;
+    const std::int64_t day = 24ll * 60 * 60 * ticks_per_second;
+
+    AnimationCurve curve;
+    curve.add_keyframe({0.f, 0.f});
+    curve.add_keyframe({0.5f, 5.f});
+    curve.add_keyframe({1.f, 10.f});
+    curve.set_wrap_mode(WrapMode::Loop);
+
+    SUBCASE("ticks evaluate like seconds") {
+        int hint = -1;
+        for (int t = -100; t <= 300; ++t) {
+            CAPTURE(t);
+            const auto ticks = static_cast<std::int64_t>(t) * 1000;
+            const auto result = curve.evaluate_ticks(ticks, ticks_per_second, hint);
+            CHECK(result.second == doctest::Approx(curve.evaluate(t / 48.f).second));
+            hint = result.first;
+        }
+    }
+
+    SUBCASE("looping stays exact after days") {
+        curve.prepare_ticks(ticks_per_second);
+        for (int i = 0; i < 8; ++i) {
+            CAPTURE(i);
+            CHECK(curve.evaluate_ticks(100 * day + i * 6000, ticks_per_second).second == doctest::Approx(i * 1.25f));
+        }
+    }
+
+    SUBCASE("changing the keyframes drops the prepared ticks") {
+        curve.prepare_ticks(ticks_per_second);
+        curve.add_keyframe({2.f, 0.f});
+        CHECK(curve.evaluate_ticks(72000, ticks_per_second).second == doctest::Approx(5.f));
+        CHECK(curve.evaluate_ticks(day + 72000, ticks_per_second).second == doctest::Approx(5.f));
+    }
+
+    SUBCASE("once clamps the ticks") {
+        curve.set_wrap_mode(WrapMode::Once);
+        CHECK(curve.evaluate_ticks(-5, ticks_per_second).second == 0.f);
+        CHECK(curve.evaluate_ticks(day, ticks_per_second).second == 10.f);
+    }
+}
+
 TEST_CASE("Testing serialization") {
     using namespace nodec_animation;
 
@@ -156,4 +275,65 @@ TEST_CASE("Testing serialization") {
         CHECK(curve.keyframes()[1].time == 50.f);
         CHECK(curve.keyframes()[2].time == 100.f);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Testing compact serialization") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::serialization;
+
+    AnimationCurve curve;
+    curve.add_keyframe({0.f, 0.0f});
+    curve.add_keyframe({0.5f, 0.5f});
+    curve.add_keyframe({1.25f, 1.0f});
+    curve.set_wrap_mode(WrapMode::Loop);
+
+    auto round_trip = [&](const CurveSaveOptions &options, std::string &json) {
+        std::stringstream ss;
+        {
+            ScopedCurveSaveOptions scope(options);
+            cereal::JSONOutputArchive archive(ss);
+            archive(cereal::make_nvp("curve", curve));
+        }
+        json = ss.str();
+
+        cereal::JSONInputArchive archive(ss);
+        AnimationCurve loaded;
+        archive(cereal::make_nvp("curve", loaded));
+        return loaded;
+    };
+
+    auto check_equal = [&](const AnimationCurve &loaded) {
+        REQUIRE(loaded.keyframes().size() == 3);
+        CHECK(loaded.wrap_mode() == WrapMode::Loop);
+        for (std::size_t i = 0; i < 3; ++i) {
+            CHECK(loaded.keyframes()[i].time == curve.keyframes()[i].time);
+            CHECK(loaded.keyframes()[i].value == curve.keyframes()[i].value);
+        }
+    };
+
+    std::string json;
+
+    SUBCASE("arrays") {
+        check_equal(round_trip({CurveEncoding::Arrays, 60.f}, json));
+        CHECK(json.find("\"times\"") != std::string::npos);
+        CHECK(json.find("\"time\"") == std::string::npos);
+    }
+
+    SUBCASE("sampled arrays") {
+        check_equal(round_trip({CurveEncoding::SampledArrays, 4.f}, json));
+        CHECK(json.find("\"frames\"") != std::string::npos);
+    }
+
+    SUBCASE("sampled arrays fall back to arrays when the times are not on frames") {
+        check_equal(round_trip({CurveEncoding::SampledArrays, 3.f}, json));
+        CHECK(json.find("\"frames\"") == std::string::npos);
+        CHECK(json.find("\"times\"") != std::string::npos);
+    }
+
+    SUBCASE("the options are restored at the end of the scope") {
+        {
+            ScopedCurveSaveOptions scope({CurveEncoding::Arrays, 60.f});
+        }
+        check_equal(round_trip(serialization::impl::curve_save_options(), json));
+        CHECK(json.find("\"keyframes\"") != std::string::npos);
+    }
+}
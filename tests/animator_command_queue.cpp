@@ -0,0 +1,101 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <thread>
+#include <vector>
+
+#include <nodec_animation/animator_command_queue.hpp>
+
+TEST_CASE("Testing animator command queue") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+    using nodec_scene::SceneEntity;
+
+    AnimatorCommandQueue queue;
+    std::vector<CoalescedAnimatorCommand> commands;
+
+    const auto entity_a = static_cast<SceneEntity>(1);
+    const auto entity_b = static_cast<SceneEntity>(2);
+    auto clip = std::make_shared<AnimationClip>();
+
+    SUBCASE("commands are coalesced per entity") {
+        queue.set_speed(entity_b, 2.f);
+        queue.seek(entity_a, 1.f);
+        queue.play(entity_a, clip);
+        queue.seek(entity_a, 3.f);
+        queue.stop(entity_b);
+        queue.set_speed(entity_b, 0.5f);
+        CHECK(!queue.empty());
+
+        queue.drain(commands);
+        CHECK(queue.empty());
+        REQUIRE(commands.size() == 2);
+
+        CHECK(commands[0].entity == entity_b);
+        CHECK(commands[0].stop);
+        CHECK(!commands[0].play);
+        CHECK(commands[0].set_speed);
+        CHECK(commands[0].speed == 0.5f);
+
+        CHECK(commands[1].entity == entity_a);
+        CHECK(commands[1].play);
+        CHECK(commands[1].clip == clip);
+        CHECK(commands[1].seek);
+        CHECK(commands[1].time == 3.f);
+        CHECK(!commands[1].set_speed);
+    }
+
+    SUBCASE("the latest of play and stop wins") {
+        queue.play(entity_a, clip);
+        queue.stop(entity_a);
+        queue.drain(commands);
+        REQUIRE(commands.size() == 1);
+        CHECK(commands[0].stop);
+        CHECK(!commands[0].play);
+        CHECK(!commands[0].clip);
+
+        queue.stop(entity_a);
+        queue.seek(entity_a, 1.f);
+        queue.play(entity_a);
+        queue.drain(commands);
+        REQUIRE(commands.size() == 1);
+        CHECK(commands[0].play);
+        CHECK(!commands[0].stop);
+        CHECK(!commands[0].seek);
+        CHECK(!commands[0].clip);
+    }
+
+    SUBCASE("producers on many threads") {
+        constexpr int thread_count = 8;
+        constexpr int commands_per_thread = 10000;
+
+        std::vector<std::thread> producers;
+        for (int t = 0; t < thread_count; ++t) {
+            producers.emplace_back([&, t]() {
+                for (int i = 1; i <= commands_per_thread; ++i) {
+                    queue.seek(static_cast<SceneEntity>(t), static_cast<float>(i));
+                }
+            });
+        }
+
+        // Drained while the producers are still pushing.
+        std::vector<float> last_times(thread_count, 0.f);
+        auto drain = [&]() {
+            queue.drain(commands);
+            for (const auto &command : commands) {
+                const auto t = static_cast<int>(command.entity);
+                // The commands of one producer arrive in order.
+                CHECK(last_times[t] < command.time);
+                last_times[t] = command.time;
+            }
+        };
+        for (int i = 0; i < 100; ++i) drain();
+
+        for (auto &producer : producers) producer.join();
+        drain();
+
+        for (int t = 0; t < thread_count; ++t) {
+            CHECK(last_times[t] == static_cast<float>(commands_per_thread));
+        }
+    }
+}
@@ -0,0 +1,954 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <thread>
+#include <vector>
+
+#include <nodec/math/math.hpp>
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_scene/scene.hpp>
+
+struct TestComponent {
+    float value{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("value", value));
+    }
+};
+
+struct HitboxComponent {
+    float offset{0.f};
+    float radius{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("offset", offset));
+        archive(cereal::make_nvp("radius", radius));
+    }
+};
+
+TEST_CASE("Testing one-shot clips to sleep after finished") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<resources::AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+    CHECK(clip->duration() == 1.f);
+    CHECK(!clip->is_looping());
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto root_entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(root_entity);
+    registry.emplace_component<Animator>(root_entity).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(root_entity);
+
+    for (int i = 0; i < 4; ++i) {
+        animator_system.update(registry, 0.5f);
+    }
+
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root_entity).value, 1.f));
+    CHECK(registry.try_get_component<AnimatorFinished>(root_entity) != nullptr);
+    CHECK(registry.try_get_component<AnimatedData>(root_entity) == nullptr);
+    CHECK(registry.try_get_component<SleepingAnimatedData>(root_entity) != nullptr);
+    CHECK(registry.get_component<AnimatorActivity>(root_entity).sleeping);
+
+    // Sleeping entities are not written anymore.
+    registry.get_component<TestComponent>(root_entity).value = 5.f;
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.get_component<TestComponent>(root_entity).value == 5.f);
+
+    // Restarting wakes the entities up without rebinding.
+    registry.emplace_component<AnimatorStart>(root_entity);
+    animator_system.update(registry, 0.5f);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root_entity).value, 0.f));
+    CHECK(registry.try_get_component<AnimatorFinished>(root_entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatedData>(root_entity) != nullptr);
+    CHECK(!registry.get_component<AnimatorActivity>(root_entity).sleeping);
+
+    registry.emplace_component<AnimatorStop>(root_entity);
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatedData>(root_entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatorActivity>(root_entity) == nullptr);
+}
+
+TEST_CASE("Testing to fire clip events") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto make_clip = [](WrapMode wrap_mode) {
+        auto clip = std::make_shared<resources::AnimationClip>();
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        curve.set_wrap_mode(wrap_mode);
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->add_event({0.75f, 2});
+        clip->add_event({0.25f, 1});
+        return clip;
+    };
+
+    auto collect_ids = [&]() {
+        std::vector<std::uint32_t> ids;
+        for (const auto &fired : animator_system.fired_events()) ids.push_back(fired.event.id);
+        return ids;
+    };
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+
+    SUBCASE("forward") {
+        registry.emplace_component<Animator>(entity).first.clip = make_clip(WrapMode::Once);
+        registry.emplace_component<AnimatorStart>(entity);
+
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids().empty());
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{1});
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{2});
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids().empty());
+    }
+
+    SUBCASE("loop with large delta time") {
+        registry.emplace_component<Animator>(entity).first.clip = make_clip(WrapMode::Loop);
+        registry.emplace_component<AnimatorStart>(entity);
+
+        animator_system.update(registry, 2.5f);
+        CHECK(collect_ids().empty());
+        animator_system.update(registry, 0.f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{1, 2, 1, 2, 1});
+    }
+
+    SUBCASE("reverse") {
+        auto &animator = registry.emplace_component<Animator>(entity).first;
+        animator.clip = make_clip(WrapMode::Once);
+        animator.speed = -1.f;
+        registry.emplace_component<AnimatorStart>(entity);
+
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids().empty());
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{2});
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{1});
+        CHECK(registry.try_get_component<AnimatorFinished>(entity) != nullptr);
+    }
+
+    SUBCASE("reverse from an event at the end") {
+        auto &animator = registry.emplace_component<Animator>(entity).first;
+        animator.clip = make_clip(WrapMode::Once);
+        animator.clip->add_event({1.f, 3});
+        animator.speed = -1.f;
+        registry.emplace_component<AnimatorStart>(entity);
+
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{3});
+        animator_system.update(registry, 0.5f);
+        CHECK(collect_ids() == std::vector<std::uint32_t>{2});
+    }
+
+    SUBCASE("loop in ticks after days of playback") {
+        animator_system.set_ticks_per_second(60000);
+        registry.emplace_component<Animator>(entity).first.clip = make_clip(WrapMode::Loop);
+        registry.emplace_component<AnimatorStart>(entity);
+
+        // Seconds in float would be a sixteenth of a second apart by now.
+        animator_system.update(registry, 1000000.f);
+        animator_system.update(registry, 0.3f);
+        animator_system.update(registry, 0.f);
+        CHECK(registry.get_component<TestComponent>(entity).value == doctest::Approx(0.3f));
+        CHECK(collect_ids() == std::vector<std::uint32_t>{1});
+    }
+}
+
+TEST_CASE("Testing animator controller transitions") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto make_constant_clip = [](float value) {
+        auto clip = std::make_shared<AnimationClip>();
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, value});
+        clip->set_curve<TestComponent>("", "value", curve);
+        return clip;
+    };
+
+    auto description = std::make_shared<AnimatorDescription>();
+    const auto run = description->add_parameter("run", AnimatorParameterType::Trigger);
+    const auto idle_state = description->add_state("idle", make_constant_clip(0.f));
+    const auto run_state = description->add_state("run", make_constant_clip(1.f));
+    const auto transition = description->add_transition(idle_state, run_state, 1.f);
+    description->add_condition(transition, run, AnimatorConditionMode::If);
+    description->set_default_state(idle_state);
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<AnimatorController>(entity).first.description = description;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    auto value = [&]() { return registry.get_component<TestComponent>(entity).value; };
+
+    animator_system.update(registry, 0.5f);
+    CHECK(value() == 0.f);
+
+    registry.get_component<AnimatorController>(entity).set_trigger(run);
+    animator_system.update(registry, 0.5f);
+    CHECK(value() == 0.f);
+    CHECK(registry.get_component<AnimatorController>(entity).get_float(run) == 0.f);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(math::approx_equal(value(), 0.5f));
+
+    animator_system.update(registry, 0.5f);
+    CHECK(value() == 1.f);
+}
+
+TEST_CASE("Testing exit times of looping states") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto idle_clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 0.f});
+        curve.set_wrap_mode(WrapMode::Loop);
+        idle_clip->set_curve<TestComponent>("", "value", curve);
+    }
+    auto run_clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 1.f});
+        run_clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    auto description = std::make_shared<AnimatorDescription>();
+    const auto go = description->add_parameter("go", AnimatorParameterType::Bool);
+    const auto idle_state = description->add_state("idle", idle_clip);
+    const auto run_state = description->add_state("run", run_clip);
+    const auto transition = description->add_transition(idle_state, run_state, 0.f, 0.5f);
+    description->add_condition(transition, go, AnimatorConditionMode::If);
+    description->set_default_state(idle_state);
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<AnimatorController>(entity).first.description = description;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    auto value = [&]() { return registry.get_component<TestComponent>(entity).value; };
+
+    // The second loop has begun.
+    for (int i = 0; i < 5; ++i) animator_system.update(registry, 0.25f);
+    registry.get_component<AnimatorController>(entity).set_bool(go, true);
+
+    SUBCASE("the exit time is reached again in the current loop") {
+        animator_system.update(registry, 0.25f);
+        CHECK(value() == 0.f);
+        animator_system.update(registry, 0.25f);
+        CHECK(value() == 1.f);
+    }
+
+    SUBCASE("the duration of the edited clip is used") {
+        idle_clip->set_duration(4.f);
+        for (int i = 0; i < 3; ++i) {
+            animator_system.update(registry, 0.25f);
+            CHECK(value() == 0.f);
+        }
+        animator_system.update(registry, 0.25f);
+        CHECK(value() == 1.f);
+    }
+}
+
+TEST_CASE("Testing to start an animator and a controller on one entity") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+    component_registry.register_component<HitboxComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 2.f});
+        clip->set_curve<HitboxComponent>("", "offset", curve);
+    }
+    auto state_clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 3.f});
+        state_clip->set_curve<TestComponent>("", "value", curve);
+    }
+    auto description = std::make_shared<AnimatorDescription>();
+    description->set_default_state(description->add_state("idle", state_clip));
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<HitboxComponent>(entity);
+    registry.emplace_component<Animator>(entity).first.clip = clip;
+    registry.emplace_component<AnimatorController>(entity).first.description = description;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    animator_system.update(registry, 0.5f);
+
+    CHECK(registry.try_get_component<AnimatorStart>(entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatorActivity>(entity) != nullptr);
+    CHECK(registry.try_get_component<AnimatorControllerActivity>(entity) != nullptr);
+    CHECK(registry.get_component<HitboxComponent>(entity).offset == 2.f);
+    CHECK(registry.get_component<TestComponent>(entity).value == 3.f);
+
+    registry.emplace_component<AnimatorStop>(entity);
+    animator_system.update(registry, 0.5f);
+
+    CHECK(registry.try_get_component<AnimatorStop>(entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatorActivity>(entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatorControllerActivity>(entity) == nullptr);
+}
+
+TEST_CASE("Testing to defer the start until the clip is loaded") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 2.f});
+        curve.add_keyframe({1.f, 3.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto request = std::make_shared<ClipRequest>("clip");
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<Animator>(entity).first.clip_request = request;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatorActivity>(entity) == nullptr);
+    CHECK(registry.try_get_component<AnimatorStart>(entity) != nullptr);
+    CHECK(registry.get_component<TestComponent>(entity).value == 0.f);
+
+    request->fulfill(clip);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatorActivity>(entity) != nullptr);
+    CHECK(registry.try_get_component<AnimatorStart>(entity) == nullptr);
+    CHECK(registry.get_component<Animator>(entity).clip == clip);
+    CHECK(!registry.get_component<Animator>(entity).clip_request);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(entity).value, 2.f));
+}
+
+TEST_CASE("Testing to stop an animator whose clip is still loading") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 2.f});
+        curve.add_keyframe({1.f, 3.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto request = std::make_shared<ClipRequest>("clip");
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<Animator>(entity).first.clip_request = request;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatorStart>(entity) != nullptr);
+
+    registry.emplace_component<AnimatorStop>(entity);
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatorStart>(entity) == nullptr);
+    CHECK(!registry.get_component<Animator>(entity).clip_request);
+
+    request->fulfill(clip);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(registry.try_get_component<AnimatorActivity>(entity) == nullptr);
+    CHECK(!registry.get_component<Animator>(entity).clip);
+    CHECK(registry.get_component<TestComponent>(entity).value == 0.f);
+}
+
+TEST_CASE("Testing property masks") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    SUBCASE("paths cover their nested properties") {
+        PropertyMask mask;
+        CHECK(mask.empty());
+        CHECK(mask.includes(type_id<TestComponent>(), "value"));
+
+        mask.include<HitboxComponent>("position").exclude<HitboxComponent>("position.z");
+        CHECK(mask.includes(type_id<HitboxComponent>(), "position"));
+        CHECK(mask.includes(type_id<HitboxComponent>(), "position.x"));
+        CHECK(!mask.includes(type_id<HitboxComponent>(), "position.z"));
+        CHECK(!mask.includes(type_id<HitboxComponent>(), "positions"));
+        CHECK(!mask.includes(type_id<TestComponent>(), "value"));
+    }
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+    component_registry.register_component<HitboxComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+    animator_system.set_property_mask(PropertyMask().include<HitboxComponent>("offset"));
+
+    AnimationCurve curve;
+    curve.add_keyframe({0.f, 1.f});
+    curve.add_keyframe({1.f, 2.f});
+
+    auto clip = std::make_shared<AnimationClip>();
+    clip->set_curve<HitboxComponent>("", "offset", curve);
+    clip->set_curve<HitboxComponent>("", "radius", curve);
+    clip->set_curve<TestComponent>("", "value", curve);
+    clip->set_curve<TestComponent>("child", "value", curve);
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto root = scene.create_entity("root");
+    auto child = scene.create_entity("child");
+    scene.hierarchy_system().append_child(root, child);
+    registry.emplace_component<HitboxComponent>(root);
+    registry.emplace_component<TestComponent>(root);
+    registry.emplace_component<TestComponent>(child);
+
+    registry.emplace_component<Animator>(root).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(root);
+    animator_system.update(registry, 0.5f);
+
+    CHECK(registry.get_component<HitboxComponent>(root).offset == 1.f);
+    CHECK(registry.get_component<HitboxComponent>(root).radius == 0.f);
+    CHECK(registry.get_component<TestComponent>(root).value == 0.f);
+    CHECK(registry.get_component<TestComponent>(child).value == 0.f);
+
+    // The child has no included property, so it is not bound at all.
+    CHECK(registry.try_get_component<AnimatedData>(child) == nullptr);
+    CHECK(registry.get_component<AnimatorActivity>(root).animated_entities.size() == 1);
+
+    animator_system.update(registry, 0.5f);
+    CHECK(math::approx_equal(registry.get_component<HitboxComponent>(root).offset, 1.5f));
+
+    SUBCASE("curves changed in place are evaluated") {
+        auto *offset_curve = clip->find_curve("", type_id<HitboxComponent>(), "offset");
+        REQUIRE(offset_curve != nullptr);
+        AnimationCurve changed_curve;
+        changed_curve.add_keyframe({0.f, 10.f});
+        changed_curve.add_keyframe({1.f, 20.f});
+        *offset_curve = changed_curve;
+
+        animator_system.update(registry, 0.5f);
+        CHECK(math::approx_equal(registry.get_component<HitboxComponent>(root).offset, 20.f));
+        CHECK(registry.get_component<HitboxComponent>(root).radius == 0.f);
+    }
+}
+
+TEST_CASE("Testing to remap animators to changed clips") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto make_curve = [](float offset) {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, offset});
+        curve.add_keyframe({10.f, offset + 10.f});
+        return curve;
+    };
+
+    auto clip = std::make_shared<AnimationClip>();
+    clip->set_curve<TestComponent>("", "value", make_curve(0.f));
+    clip->set_curve<TestComponent>("child", "value", make_curve(0.f));
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto root = scene.create_entity("root");
+    auto child = scene.create_entity("child");
+    auto other_child = scene.create_entity("other_child");
+    scene.hierarchy_system().append_child(root, child);
+    scene.hierarchy_system().append_child(root, other_child);
+    registry.emplace_component<TestComponent>(root);
+    registry.emplace_component<TestComponent>(child);
+    registry.emplace_component<TestComponent>(other_child);
+
+    registry.emplace_component<Animator>(root).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(root);
+    animator_system.update(registry, 1.f);
+    animator_system.update(registry, 1.f);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 1.f));
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 1.f));
+
+    const auto *root_data = registry.try_get_component<AnimatedData>(root);
+
+    SUBCASE("changing a curve keeps the time") {
+        clip->set_curve<TestComponent>("", "value", make_curve(100.f));
+        CHECK(registry.get_component<AnimatedData>(root).is_stale());
+
+        animator_system.update(registry, 1.f);
+        CHECK(registry.try_get_component<AnimatedData>(root) == root_data);
+        CHECK(!registry.get_component<AnimatedData>(root).is_stale());
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 102.f));
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 2.f));
+    }
+
+    SUBCASE("replacing the root entity rebinds the hierarchy") {
+        AnimationClip replacement;
+        replacement.set_curve<TestComponent>("", "value", make_curve(100.f));
+        replacement.set_curve<TestComponent>("other_child", "value", make_curve(200.f));
+        auto root_entity = replacement.root_entity();
+        clip->set_root_entity(std::move(root_entity));
+
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 102.f));
+        // The newly bound entity plays in step with the others.
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(other_child).value, 202.f));
+
+        // The child is no longer animated and keeps its last value.
+        CHECK(registry.try_get_component<AnimatedData>(child) == nullptr);
+        CHECK(registry.get_component<AnimatorActivity>(root).animated_entities.size() == 2);
+
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 1.f));
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(other_child).value, 203.f));
+    }
+}
+
+TEST_CASE("Testing animator commands") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({10.f, 10.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto root = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(root);
+
+    auto &commands = animator_system.command_queue();
+
+    // Played and sought from another thread, applied in one batch.
+    std::thread([&]() {
+        commands.play(root, clip);
+        commands.seek(root, 4.f);
+        commands.set_speed(root, 2.f);
+    }).join();
+
+    animator_system.update(registry, 1.f);
+    CHECK(registry.get_component<Animator>(root).clip == clip);
+    CHECK(registry.try_get_component<AnimatorStart>(root) == nullptr);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 4.f));
+
+    animator_system.update(registry, 1.f);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 6.f));
+
+    // Seeking back wakes finished animators up.
+    commands.seek(root, 20.f);
+    animator_system.update(registry, 1.f);
+    CHECK(registry.try_get_component<AnimatorFinished>(root) != nullptr);
+    commands.seek(root, 1.f);
+    animator_system.update(registry, 1.f);
+    CHECK(registry.try_get_component<AnimatorFinished>(root) == nullptr);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 1.f));
+
+    commands.stop(root);
+    animator_system.update(registry, 1.f);
+    CHECK(registry.try_get_component<AnimatorActivity>(root) == nullptr);
+}
+
+TEST_CASE("Testing animator commands while the clip is loading") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({10.f, 10.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto request = std::make_shared<ClipRequest>("clip");
+
+    auto root = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(root);
+    registry.emplace_component<Animator>(root).first.clip_request = request;
+    registry.emplace_component<AnimatorStart>(root);
+
+    auto &commands = animator_system.command_queue();
+    commands.seek(root, 4.f);
+    commands.set_speed(root, 2.f);
+
+    animator_system.update(registry, 1.f);
+    animator_system.update(registry, 1.f);
+    CHECK(registry.try_get_component<AnimatorActivity>(root) == nullptr);
+
+    SUBCASE("kept until the animator has started") {
+        request->fulfill(clip);
+
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 4.f));
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 6.f));
+    }
+
+    SUBCASE("a later play cancels the seek") {
+        commands.play(root, clip);
+
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 0.f));
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 2.f));
+    }
+
+    SUBCASE("a stop drops them") {
+        commands.stop(root);
+        animator_system.update(registry, 1.f);
+        request->fulfill(clip);
+
+        registry.emplace_component<AnimatorStart>(root);
+        registry.get_component<Animator>(root).clip = clip;
+        registry.get_component<Animator>(root).speed = 1.f;
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 0.f));
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 1.f));
+    }
+}
+
+TEST_CASE("Testing lazy evaluation") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({4.f, 4.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("child", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto root = scene.create_entity("root");
+    auto child = scene.create_entity("child");
+    scene.hierarchy_system().append_child(root, child);
+    registry.emplace_component<TestComponent>(root);
+    registry.emplace_component<TestComponent>(child);
+    registry.emplace_component<LazyEvaluation>(child);
+
+    registry.emplace_component<Animator>(root).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(root);
+
+    animator_system.update(registry, 1.f);
+    animator_system.update(registry, 1.f);
+
+    // Only the clock of the lazy entity has advanced.
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(root).value, 1.f));
+    CHECK(registry.get_component<TestComponent>(child).value == 0.f);
+
+    // The pose is the one the last update would have written.
+    CHECK(animator_system.evaluate(registry, child) == 1);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 1.f));
+    CHECK(animator_system.evaluate(registry, child) == 0);
+
+    SUBCASE("the final pose is written after finishing") {
+        for (int i = 0; i < 4; ++i) animator_system.update(registry, 1.f);
+        CHECK(registry.try_get_component<SleepingAnimatedData>(child) != nullptr);
+        CHECK(animator_system.evaluate(registry, root) == 1);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 4.f));
+    }
+
+    SUBCASE("removing the marker evaluates eagerly again") {
+        registry.remove_component<LazyEvaluation>(child);
+        animator_system.update(registry, 1.f);
+        CHECK(math::approx_equal(registry.get_component<TestComponent>(child).value, 2.f));
+    }
+}
+
+TEST_CASE("Testing evaluation order") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+    CHECK(animator_system.evaluation_order() == EvaluationOrder::clip_hierarchy);
+
+    auto make_clip = [](float offset) {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, offset});
+        curve.add_keyframe({100.f, offset + 100.f});
+        auto clip = std::make_shared<AnimationClip>();
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("child", "value", curve);
+        return clip;
+    };
+    auto clip_a = make_clip(0.f);
+    auto clip_b = make_clip(1000.f);
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    std::vector<SceneEntity> roots;
+    std::vector<SceneEntity> children;
+    for (int i = 0; i < 4; ++i) {
+        auto root = scene.create_entity("root");
+        auto child = scene.create_entity("child");
+        scene.hierarchy_system().append_child(root, child);
+        registry.emplace_component<TestComponent>(root);
+        registry.emplace_component<TestComponent>(child);
+        registry.emplace_component<Animator>(root).first.clip = i % 2 ? clip_b : clip_a;
+        registry.emplace_component<AnimatorStart>(root);
+        roots.push_back(root);
+        children.push_back(child);
+    }
+
+    animator_system.update(registry, 1.f);
+
+    // Churn: stopped, restarted with the same and with the other clip.
+    registry.emplace_component<AnimatorStop>(roots[0]);
+    registry.emplace_component<AnimatorStop>(roots[1]);
+    animator_system.update(registry, 1.f);
+    registry.emplace_component<AnimatorStart>(roots[0]);
+    registry.get_component<Animator>(roots[1]).clip = clip_a;
+    registry.emplace_component<AnimatorStart>(roots[1]);
+    registry.emplace_component<AnimatorStart>(roots[2]);
+    animator_system.update(registry, 1.f);
+
+    SUBCASE("every entity is evaluated once per update") {
+        animator_system.update(registry, 1.f);
+        animator_system.update(registry, 1.f);
+
+        const float expected[] = {2.f, 2.f, 2.f, 1004.f};
+        for (int i = 0; i < 4; ++i) {
+            CHECK(math::approx_equal(registry.get_component<TestComponent>(roots[i]).value, expected[i]));
+            CHECK(math::approx_equal(registry.get_component<TestComponent>(children[i]).value, expected[i]));
+        }
+    }
+
+    SUBCASE("switching the order") {
+        animator_system.set_evaluation_order(EvaluationOrder::storage);
+        animator_system.update(registry, 1.f);
+        animator_system.set_evaluation_order(EvaluationOrder::clip_hierarchy);
+        animator_system.update(registry, 1.f);
+
+        const float expected[] = {2.f, 2.f, 2.f, 1004.f};
+        for (int i = 0; i < 4; ++i) {
+            CHECK(math::approx_equal(registry.get_component<TestComponent>(roots[i]).value, expected[i]));
+        }
+    }
+}
+
+TEST_CASE("Testing to bind started animators in parallel") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    ThreadParallelExecutor executor(4);
+    AnimatorSystem animator_system(component_registry);
+    animator_system.set_executor(&executor);
+
+    auto clip = std::make_shared<AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 1.f});
+        curve.add_keyframe({1.f, 2.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("child/grandchild", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    const int animator_count = static_cast<int>(AnimatorSystem::min_parallel_bind_jobs) * 2;
+    std::vector<SceneEntity> roots;
+    std::vector<SceneEntity> grandchildren;
+    for (int i = 0; i < animator_count; ++i) {
+        auto root = scene.create_entity("root");
+        auto child = scene.create_entity("child");
+        auto grandchild = scene.create_entity("grandchild");
+        scene.hierarchy_system().append_child(root, child);
+        scene.hierarchy_system().append_child(child, grandchild);
+        registry.emplace_component<TestComponent>(root);
+        registry.emplace_component<TestComponent>(grandchild);
+        registry.emplace_component<Animator>(root).first.clip = clip;
+        registry.emplace_component<AnimatorStart>(root);
+        roots.push_back(root);
+        grandchildren.push_back(grandchild);
+    }
+
+    animator_system.update(registry, 0.5f);
+
+    for (int i = 0; i < animator_count; ++i) {
+        const auto &animator_activity = registry.get_component<AnimatorActivity>(roots[i]);
+        REQUIRE(animator_activity.animated_entities.size() == 3);
+        CHECK(animator_activity.animated_entities[0] == roots[i]);
+        CHECK(animator_activity.animated_entities[2] == grandchildren[i]);
+        CHECK(registry.get_component<TestComponent>(roots[i]).value == 1.f);
+        CHECK(registry.get_component<TestComponent>(grandchildren[i]).value == 1.f);
+    }
+
+    animator_system.update(registry, 0.5f);
+    CHECK(math::approx_equal(registry.get_component<TestComponent>(grandchildren.back()).value, 1.5f));
+}
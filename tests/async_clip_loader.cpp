@@ -0,0 +1,62 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <nodec_animation/resources/async_clip_loader.hpp>
+
+struct ComponentA {
+    float prop;
+};
+
+TEST_CASE("Testing AsyncClipLoader") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    std::atomic<int> load_count{0};
+
+    AsyncClipLoader loader([&](const std::string &name) -> std::shared_ptr<AnimationClip> {
+        ++load_count;
+        if (name == "broken") throw std::runtime_error("broken clip");
+        if (name == "missing") return nullptr;
+
+        auto clip = std::make_shared<AnimationClip>();
+        AnimationCurve curve;
+        curve.add_keyframe({static_cast<float>(name.size()), 0.f});
+        clip->set_curve<ComponentA>("", "prop", curve);
+        return clip;
+    },
+                           4);
+
+    std::vector<std::shared_ptr<ClipRequest>> requests;
+    for (int i = 0; i < 32; ++i) {
+        requests.push_back(loader.request(std::string(i + 1, 'a')));
+    }
+    auto same = loader.request("a");
+    auto broken = loader.request("broken");
+    auto missing = loader.request("missing");
+
+    CHECK(same == requests[0]);
+
+    loader.wait_all();
+    CHECK(loader.pending_count() == 0);
+    CHECK(load_count == 34);
+
+    for (int i = 0; i < 32; ++i) {
+        REQUIRE(requests[i]->ready());
+        REQUIRE(requests[i]->clip());
+        CHECK(requests[i]->clip()->duration() == static_cast<float>(i + 1));
+    }
+
+    CHECK(broken->ready());
+    CHECK(!broken->clip());
+    CHECK(missing->ready());
+    CHECK(!missing->clip());
+
+    loader.clear_finished();
+    auto reloaded = loader.request("a");
+    CHECK(reloaded != requests[0]);
+    loader.wait_all();
+    CHECK(load_count == 35);
+}
@@ -0,0 +1,132 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <cstdio>
+#include <vector>
+
+#include <nodec_animation/serialization/binary_clip.hpp>
+
+struct ComponentA {
+    float prop;
+};
+struct ComponentB {
+    float prop;
+};
+struct UnknownComponent {
+    float prop;
+};
+
+TEST_CASE("Testing binary clips") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::serialization;
+
+    AnimationClip clip;
+    {
+        AnimationCurve curve;
+        for (int i = 0; i < 8; ++i) {
+            curve.add_keyframe({static_cast<float>(i), static_cast<float>(i * i)});
+        }
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip.set_curve<ComponentA>("", "prop", curve);
+        clip.set_curve<ComponentA>("b/c", "prop", curve);
+        clip.set_curve<ComponentB>("a", "prop", curve);
+        clip.set_curve<UnknownComponent>("a", "prop", curve);
+        clip.add_event({2.5f, 7, 3, 1.5f});
+    }
+
+    BinaryClipTypeTable types;
+    types.register_type<ComponentA>("ComponentA");
+    types.register_type<ComponentB>("ComponentB");
+
+    std::vector<char> data;
+    CHECK(!write_binary_clip(clip, types, data));
+
+    types.register_type<UnknownComponent>("UnknownComponent");
+    REQUIRE(write_binary_clip(clip, types, data));
+
+    BinaryClipView view(data.data(), data.size());
+    REQUIRE(view.valid());
+    CHECK(view.header().entity_count == 4);
+    CHECK(view.find_child(0, "a") >= 0);
+    CHECK(view.find_child(0, "c") == -1);
+
+    SUBCASE("keyframes are read in place") {
+        const auto &property = view.properties()[view.components()[view.entities()[0].component_begin].property_begin];
+        CHECK(property.keyframe_end - property.keyframe_begin == 8);
+        CHECK(view.keyframes()[property.keyframe_begin + 3].value == 9.f);
+    }
+
+    SUBCASE("loading") {
+        BinaryClipTypeTable loading_types;
+        loading_types.register_type<ComponentA>("ComponentA");
+        loading_types.register_type<ComponentB>("ComponentB");
+
+        auto arena = std::make_shared<MonotonicArena>();
+        auto loaded = load_binary_clip(view, loading_types, arena);
+        REQUIRE(loaded);
+
+        const auto &curve = loaded->root_entity().children.at("b").children.at("c").components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+        CHECK(curve.keyframes().size() == 8);
+        CHECK(curve.get_allocator().arena() == arena.get());
+        // Without the owner of the bytes, the keyframes are copied.
+        CHECK(!curve.referenced_keyframes());
+        CHECK(curve.wrap_mode() == WrapMode::Loop);
+
+        // Unknown component types are skipped.
+        CHECK(loaded->root_entity().children.at("a").components.size() == 1);
+
+        CHECK(loaded->duration() == 7.f);
+        CHECK(loaded->is_looping());
+        REQUIRE(loaded->events().size() == 1);
+        CHECK(loaded->events()[0].id == 7);
+        CHECK(loaded->events()[0].float_payload == 1.5f);
+    }
+
+    SUBCASE("keyframes are referenced in place while the owner is kept alive") {
+        auto owned = std::make_shared<std::vector<char>>(data);
+        std::weak_ptr<std::vector<char>> weak = owned;
+
+        BinaryClipView owned_view(owned->data(), owned->size());
+        REQUIRE(owned_view.valid());
+        auto loaded = load_binary_clip(owned_view, types, nullptr, owned);
+        owned.reset();
+        REQUIRE(loaded);
+
+        auto curve = loaded->root_entity().components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+        CHECK(curve.keyframes().data() == owned_view.keyframes());
+        CHECK(curve.evaluate(2.5f).second == 6.5f);
+
+        loaded.reset();
+        CHECK(!weak.expired());
+
+        // Changing the curve copies the keyframes and lets go of the bytes.
+        curve.add_keyframe({8.f, 64.f});
+        CHECK(weak.expired());
+        CHECK(curve.keyframes().size() == 9);
+        CHECK(curve.evaluate(2.5f).second == 6.5f);
+    }
+
+    SUBCASE("memory-mapped file") {
+        const char *path = "nodec_animation__binary_clip.nacl";
+        REQUIRE(write_binary_clip(clip, types, path));
+
+        auto loaded = load_binary_clip(path, types);
+        std::remove(path);
+        REQUIRE(loaded);
+        CHECK(loaded->root_entity().children.at("a").components.size() == 2);
+
+        const auto &curve = loaded->root_entity().components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+        CHECK(curve.referenced_keyframes());
+        CHECK(curve.evaluate(3.f).second == 9.f);
+    }
+
+    SUBCASE("corrupted data is rejected") {
+        auto corrupted = data;
+        corrupted[0] = 'X';
+        CHECK(!BinaryClipView(corrupted.data(), corrupted.size()).valid());
+
+        CHECK(!BinaryClipView(data.data(), data.size() - 16).valid());
+        CHECK(!load_binary_clip(BinaryClipView(), types));
+    }
+}
@@ -0,0 +1,186 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <vector>
+
+#include <nodec_animation/resources/clip_database.hpp>
+#include <nodec_animation/resources/curve_store.hpp>
+
+struct ComponentA {
+    float prop;
+};
+
+TEST_CASE("Testing the clip database") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    auto make_clip = [](int seed) {
+        auto clip = std::make_shared<AnimationClip>();
+        for (int entity = 0; entity < 4; ++entity) {
+            AnimationCurve curve;
+            for (int i = 0; i < 16; ++i) curve.add_keyframe({i * 0.25f, static_cast<float>(seed * 100 + entity * 10 + i)});
+            clip->set_curve<ComponentA>(entity == 0 ? "" : "child" + std::to_string(entity), "prop", curve);
+        }
+        return clip;
+    };
+
+    auto curve_of = [](const AnimationClip &clip, const std::string &child) -> const AnimationCurve & {
+        const auto &entity = child.empty() ? clip.root_entity() : clip.root_entity().children.at(child);
+        return entity.components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+    };
+
+    ClipDatabase::Options options;
+    options.compaction_threshold = 0.f;
+    ClipDatabase database(options);
+
+    std::vector<ClipHandle> handles;
+    for (int i = 0; i < 8; ++i) handles.push_back(database.add(make_clip(i)));
+
+    CHECK(database.clip_count() == 8);
+    CHECK(database.block_count() == 1);
+
+    const auto bytes_per_clip = 4 * (sizeof(AnimationCurve::KeyframeVector) + 16 * sizeof(Keyframe));
+    CHECK(database.live_bytes() == 8 * bytes_per_clip);
+
+    SUBCASE("keyframes are packed one after another") {
+        const auto &first = curve_of(*database.get(handles[0]), "");
+        const auto &second = curve_of(*database.get(handles[1]), "");
+        REQUIRE(first.shared_keyframes());
+
+        const auto *begin = reinterpret_cast<const char *>(first.keyframes().data());
+        const auto *next = reinterpret_cast<const char *>(second.keyframes().data());
+        CHECK(begin < next);
+        CHECK(next - begin < static_cast<std::ptrdiff_t>(2 * bytes_per_clip));
+
+        CHECK(first.evaluate(0.6f).second == doctest::Approx(2.4f));
+        CHECK(curve_of(*database.get(handles[3]), "child2").evaluate(1.f).second == 324.f);
+    }
+
+    SUBCASE("handles of removed clips are stale") {
+        auto removed = database.get(handles[2]);
+        CHECK(database.remove(handles[2]));
+        CHECK(!database.remove(handles[2]));
+        CHECK(!database.get(handles[2]));
+        CHECK(!database.contains(handles[2]));
+
+        auto handle = database.add(make_clip(9));
+        CHECK(handle.index == handles[2].index);
+        CHECK(handle != handles[2]);
+        CHECK(database.get(handle));
+
+        // Still usable, since it keeps its keyframes alive.
+        CHECK(curve_of(*removed, "").evaluate(0.f).second == 200.f);
+    }
+
+    SUBCASE("removed clips are forgotten once their keyframes are freed") {
+        CHECK(database.shared_keyframes_count() == 8 * 4);
+
+        auto removed = database.get(handles[2]);
+        database.remove(handles[2]);
+        // Still findable for copies of the removed clip in use.
+        CHECK(database.shared_keyframes_count() == 8 * 4);
+
+        removed.reset();
+        database.remove(handles[3]);
+        CHECK(database.shared_keyframes_count() == 6 * 4);
+
+        for (int i = 0; i < 64; ++i) database.remove(database.add(make_clip(i)));
+        CHECK(database.shared_keyframes_count() == 6 * 4);
+    }
+
+    SUBCASE("compaction closes the holes") {
+        auto removed = database.get(handles[0]);
+        for (int i = 0; i < 4; ++i) database.remove(handles[i]);
+        CHECK(database.live_bytes() == 4 * bytes_per_clip);
+        CHECK(database.packed_bytes() == 8 * bytes_per_clip);
+
+        database.compact();
+        CHECK(database.packed_bytes() == 4 * bytes_per_clip);
+        CHECK(database.block_count() == 1);
+        CHECK(curve_of(*database.get(handles[5]), "child1").evaluate(0.5f).second == 512.f);
+
+        // The old buffer outlives the compaction for the clips which were removed but are still in use.
+        CHECK(curve_of(*removed, "child3").evaluate(0.25f).second == 31.f);
+    }
+
+    SUBCASE("removing enough clips compacts automatically") {
+        ClipDatabase automatic;
+        std::vector<ClipHandle> automatic_handles;
+        for (int i = 0; i < 4; ++i) automatic_handles.push_back(automatic.add(make_clip(i)));
+
+        automatic.remove(automatic_handles[0]);
+        automatic.remove(automatic_handles[1]);
+        CHECK(automatic.packed_bytes() == 4 * bytes_per_clip);
+        automatic.remove(automatic_handles[2]);
+        CHECK(automatic.packed_bytes() == bytes_per_clip);
+    }
+
+    SUBCASE("huge pages") {
+        ClipDatabase::Options huge_options;
+        huge_options.huge_pages = true;
+        ClipDatabase huge(huge_options);
+        auto handle = huge.add(make_clip(1));
+        CHECK(huge.reserved_bytes() >= MonotonicArena::huge_page_size);
+        CHECK(curve_of(*huge.get(handle), "").evaluate(1.f).second == 104.f);
+    }
+}
+
+TEST_CASE("Testing the clip database with curves shared by a curve store") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    AnimationCurve idle;
+    for (int i = 0; i < 16; ++i) idle.add_keyframe({i * 0.25f, static_cast<float>(i % 5)});
+
+    auto make_clip = [&]() {
+        auto clip = std::make_shared<AnimationClip>();
+        clip->set_curve<ComponentA>("", "prop", idle);
+        clip->set_curve<ComponentA>("arm", "prop", idle);
+        return clip;
+    };
+
+    auto curve_of = [](const AnimationClip &clip, const std::string &child) -> const AnimationCurve & {
+        const auto &entity = child.empty() ? clip.root_entity() : clip.root_entity().children.at(child);
+        return entity.components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+    };
+
+    CurveStore store;
+    std::vector<std::shared_ptr<AnimationClip>> clips;
+    for (int i = 0; i < 3; ++i) {
+        clips.push_back(make_clip());
+        store.deduplicate(*clips.back());
+    }
+
+    ClipDatabase::Options options;
+    options.compaction_threshold = 0.f;
+    ClipDatabase database(options);
+
+    auto first = database.add(clips[0]);
+    database.add(clips[1]);
+
+    // Packed once for both clips.
+    const auto &packed = curve_of(*clips[0], "").shared_keyframes();
+    REQUIRE(packed);
+    CHECK(curve_of(*clips[0], "arm").shared_keyframes() == packed);
+    CHECK(curve_of(*clips[1], "").shared_keyframes() == packed);
+    CHECK(database.live_bytes() == sizeof(AnimationCurve::KeyframeVector) + 16 * sizeof(Keyframe));
+
+    // Copies of packed curves find their keyframes packed already.
+    auto copied = std::make_shared<AnimationClip>();
+    copied->set_curve<ComponentA>("", "prop", curve_of(*clips[1], ""));
+    REQUIRE(curve_of(*copied, "").shared_keyframes() == packed);
+    database.add(copied);
+    CHECK(database.packed_bytes() == sizeof(AnimationCurve::KeyframeVector) + 16 * sizeof(Keyframe));
+
+    database.remove(first);
+    database.compact();
+    const auto &compacted = curve_of(*clips[1], "").shared_keyframes();
+    CHECK(compacted != curve_of(*clips[0], "").shared_keyframes());
+
+    // The last clip still shares the keyframes of the store, which lead to the compacted keyframes.
+    database.add(clips[2]);
+    CHECK(curve_of(*clips[2], "").shared_keyframes() == compacted);
+    CHECK(curve_of(*clips[2], "arm").shared_keyframes() == compacted);
+    CHECK(curve_of(*clips[2], "arm").evaluate(0.5f).second == 2.f);
+    CHECK(database.packed_bytes() == sizeof(AnimationCurve::KeyframeVector) + 16 * sizeof(Keyframe));
+}
@@ -0,0 +1,100 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <vector>
+
+#include <nodec_animation/resources/curve_store.hpp>
+#include <nodec_animation/serialization/binary_clip.hpp>
+
+struct ComponentA {
+    float prop;
+};
+
+TEST_CASE("Testing curve deduplication") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+
+    AnimationCurve idle;
+    for (int i = 0; i < 10; ++i) idle.add_keyframe({i * 0.5f, static_cast<float>(i % 3)});
+
+    AnimationCurve other;
+    other.add_keyframe({0.f, 1.f});
+    other.add_keyframe({1.f, 2.f});
+
+    auto make_clip = [&]() {
+        auto clip = std::make_shared<AnimationClip>();
+        clip->set_curve<ComponentA>("", "prop", idle);
+        clip->set_curve<ComponentA>("arm", "prop", idle);
+        clip->set_curve<ComponentA>("leg", "prop", idle);
+        clip->set_curve<ComponentA>("head", "prop", other);
+        return clip;
+    };
+
+    CurveStore store;
+    auto clip_a = make_clip();
+    auto clip_b = make_clip();
+    store.deduplicate(*clip_a);
+    store.deduplicate(*clip_b);
+
+    const auto &root_curve = clip_a->root_entity().components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+    const auto &arm_curve = clip_b->root_entity().children.at("arm").components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve;
+    REQUIRE(root_curve.shared_keyframes());
+    CHECK(root_curve.shared_keyframes() == arm_curve.shared_keyframes());
+    CHECK(root_curve.keyframes().size() == 10);
+    CHECK(root_curve.evaluate(1.25f).second == idle.evaluate(1.25f).second);
+    CHECK(clip_a->duration() == idle.keyframes().back().time);
+
+    // Short curves keep their keyframes inline.
+    CHECK(!clip_a->root_entity().children.at("head").components.at(nodec::type_id<ComponentA>()).properties.at("prop").curve.shared_keyframes());
+
+    SUBCASE("the report shows the shared bytes") {
+        const auto report = store.report();
+        CHECK(report.curve_count == 6);
+        CHECK(report.unique_curve_count == 1);
+        CHECK(report.total_keyframe_bytes == 6 * 10 * sizeof(Keyframe));
+        CHECK(report.unique_keyframe_bytes == 10 * sizeof(Keyframe));
+    }
+
+    SUBCASE("deduplicating twice changes nothing") {
+        store.deduplicate(*clip_a);
+        CHECK(store.report().curve_count == 6);
+    }
+
+    SUBCASE("changing a shared curve copies it") {
+        AnimationCurve curve = root_curve;
+        CHECK(curve.shared_keyframes() == root_curve.shared_keyframes());
+        curve.add_keyframe({10.f, 10.f});
+        CHECK(!curve.shared_keyframes());
+        CHECK(curve.keyframes().size() == 11);
+        CHECK(root_curve.keyframes().size() == 10);
+    }
+
+    SUBCASE("keyframes are freed with the last clip using them") {
+        clip_a.reset();
+        CHECK(store.report().curve_count == 3);
+        clip_b.reset();
+        CHECK(store.report().unique_curve_count == 0);
+        store.collect();
+        CHECK(store.report().unique_keyframe_bytes == 0);
+    }
+
+    SUBCASE("loaded clips are deduplicated within the scope") {
+        serialization::BinaryClipTypeTable types;
+        types.register_type<ComponentA>("ComponentA");
+
+        std::vector<char> data;
+        REQUIRE(serialization::write_binary_clip(*make_clip(), types, data));
+
+        std::shared_ptr<AnimationClip> loaded;
+        {
+            ScopedCurveDeduplication scope(store);
+            loaded = serialization::load_binary_clip(serialization::BinaryClipView(data.data(), data.size()), types);
+        }
+        REQUIRE(loaded);
+        CHECK(store.report().curve_count == 9);
+        CHECK(store.report().unique_curve_count == 1);
+
+        auto unshared = serialization::load_binary_clip(serialization::BinaryClipView(data.data(), data.size()), types);
+        CHECK(store.report().curve_count == 9);
+    }
+}
@@ -0,0 +1,26 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <atomic>
+#include <vector>
+
+#include <nodec_animation/parallel_executor.hpp>
+
+TEST_CASE("Testing thread parallel executor") {
+    using namespace nodec_animation;
+
+    for (unsigned thread_count : {0u, 1u, 4u, 64u}) {
+        ThreadParallelExecutor executor(thread_count);
+
+        std::vector<std::atomic<int>> calls(1000);
+        for (auto &call : calls) call = 0;
+        executor.run(calls.size(), [&](std::size_t index) { ++calls[index]; });
+
+        bool once = true;
+        for (auto &call : calls) once = once && call == 1;
+        CHECK(once);
+
+        executor.run(0, [&](std::size_t) { CHECK(false); });
+        executor.run(1, [&](std::size_t index) { CHECK(index == 0); });
+    }
+}
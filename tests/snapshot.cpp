@@ -0,0 +1,158 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <vector>
+
+#include <nodec/math/math.hpp>
+#include <nodec_animation/serialization/snapshot.hpp>
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_scene/scene.hpp>
+
+struct TestComponent {
+    float value{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("value", value));
+    }
+};
+
+TEST_CASE("Testing snapshot deltas") {
+    using namespace nodec_animation::serialization;
+
+    std::vector<char> base(1000);
+    for (std::size_t i = 0; i < base.size(); ++i) base[i] = static_cast<char>(i * 7);
+
+    std::vector<char> snapshot = base;
+    snapshot[10] = 1;
+    snapshot[12] = 2;
+    snapshot[500] = 3;
+
+    std::vector<char> delta;
+    std::vector<char> decoded;
+
+    SUBCASE("only the changed bytes are stored") {
+        encode_snapshot_delta(base, snapshot, delta);
+        CHECK(delta.size() < sizeof(SnapshotDeltaHeader) + 16);
+        REQUIRE(decode_snapshot_delta(base, delta.data(), delta.size(), decoded));
+        CHECK(decoded == snapshot);
+    }
+
+    SUBCASE("snapshots of another size") {
+        snapshot.resize(1200, 5);
+        encode_snapshot_delta(base, snapshot, delta);
+        REQUIRE(decode_snapshot_delta(base, delta.data(), delta.size(), decoded));
+        CHECK(decoded == snapshot);
+
+        snapshot.resize(300);
+        encode_snapshot_delta(base, snapshot, delta);
+        REQUIRE(decode_snapshot_delta(base, delta.data(), delta.size(), decoded));
+        CHECK(decoded == snapshot);
+
+        encode_snapshot_delta(std::vector<char>(), snapshot, delta);
+        REQUIRE(decode_snapshot_delta(std::vector<char>(), delta.data(), delta.size(), decoded));
+        CHECK(decoded == snapshot);
+    }
+
+    SUBCASE("invalid deltas") {
+        encode_snapshot_delta(base, snapshot, delta);
+        CHECK(!decode_snapshot_delta(snapshot, delta.data(), delta.size() - 1, decoded));
+        CHECK(!decode_snapshot_delta(std::vector<char>(10), delta.data(), delta.size(), decoded));
+        CHECK(!decode_snapshot_delta(base, delta.data(), 4, decoded));
+    }
+}
+
+TEST_CASE("Testing snapshot and restore") {
+    using namespace nodec;
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::components::impl;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto make_clip = [](WrapMode wrap_mode) {
+        auto clip = std::make_shared<AnimationClip>();
+        AnimationCurve curve;
+        for (int i = 0; i <= 8; ++i) curve.add_keyframe({i * 0.25f, static_cast<float>(i)});
+        curve.set_wrap_mode(wrap_mode);
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<TestComponent>("child", "value", curve);
+        clip->add_event({1.f, 1});
+        return clip;
+    };
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto looping = scene.create_entity("looping");
+    auto looping_child = scene.create_entity("child");
+    scene.hierarchy_system().append_child(looping, looping_child);
+    auto once = scene.create_entity("once");
+
+    for (auto entity : {looping, looping_child, once}) registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<Animator>(looping).first.clip = make_clip(WrapMode::Loop);
+    registry.emplace_component<AnimatorStart>(looping);
+    registry.emplace_component<Animator>(once).first.clip = make_clip(WrapMode::Once);
+    registry.emplace_component<AnimatorStart>(once);
+
+    auto values = [&]() {
+        return std::vector<float>{registry.get_component<TestComponent>(looping).value,
+                                  registry.get_component<TestComponent>(looping_child).value,
+                                  registry.get_component<TestComponent>(once).value};
+    };
+
+    animator_system.update(registry, 0.3f);
+    animator_system.update(registry, 0.3f);
+
+    std::vector<char> snapshot;
+    animator_system.save_snapshot(registry, snapshot);
+
+    std::vector<std::vector<float>> expected;
+    std::vector<std::size_t> expected_events;
+    for (int i = 0; i < 8; ++i) {
+        animator_system.update(registry, 0.3f);
+        expected.push_back(values());
+        expected_events.push_back(animator_system.fired_events().size());
+    }
+    CHECK(registry.try_get_component<AnimatorFinished>(once) != nullptr);
+    CHECK(registry.try_get_component<SleepingAnimatedData>(once) != nullptr);
+
+    REQUIRE(animator_system.restore_snapshot(registry, snapshot.data(), snapshot.size()));
+    CHECK(registry.try_get_component<AnimatorFinished>(once) == nullptr);
+    CHECK(registry.try_get_component<AnimatedData>(once) != nullptr);
+    CHECK(!registry.get_component<AnimatorActivity>(once).sleeping);
+
+    for (int i = 0; i < 8; ++i) {
+        animator_system.update(registry, 0.3f);
+        CHECK(values() == expected[i]);
+        CHECK(animator_system.fired_events().size() == expected_events[i]);
+    }
+
+    SUBCASE("deltas restore the same state") {
+        std::vector<char> later;
+        animator_system.save_snapshot(registry, later);
+
+        std::vector<char> delta;
+        serialization::encode_snapshot_delta(snapshot, later, delta);
+        CHECK(delta.size() < later.size());
+
+        std::vector<char> decoded;
+        REQUIRE(serialization::decode_snapshot_delta(snapshot, delta.data(), delta.size(), decoded));
+        CHECK(decoded == later);
+    }
+
+    SUBCASE("snapshots only restore into the same bindings") {
+        registry.emplace_component<AnimatorStop>(looping);
+        animator_system.update(registry, 0.3f);
+        CHECK(!animator_system.restore_snapshot(registry, snapshot.data(), snapshot.size()));
+
+        snapshot[0] = 'X';
+        CHECK(!animator_system.restore_snapshot(registry, snapshot.data(), snapshot.size()));
+    }
+}
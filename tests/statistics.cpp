@@ -0,0 +1,120 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#ifndef NODEC_ANIMATION_ENABLE_STATISTICS
+#    define NODEC_ANIMATION_ENABLE_STATISTICS
+#endif
+
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_scene/scene.hpp>
+
+struct TestComponent {
+    float value{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("value", value));
+    }
+};
+
+struct UnregisteredComponent {
+    float value{0.f};
+};
+
+TEST_CASE("Testing statistics of AnimatorSystem") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<resources::AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        curve.add_keyframe({2.f, 0.f});
+        curve.set_wrap_mode(WrapMode::Loop);
+        clip->set_curve<TestComponent>("", "value", curve);
+        clip->set_curve<UnregisteredComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<Animator>(entity).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    animator_system.update(registry, 0.1f);
+    {
+        const auto &statistics = animator_system.statistics();
+        CHECK(statistics.active_animators == 1);
+        CHECK(statistics.bound_entities == 1);
+        CHECK(statistics.curves_evaluated == 1);
+        CHECK(statistics.upper_bound_fallbacks == 1);
+        CHECK(statistics.property_writes == 1);
+        CHECK(statistics.handler_misses == 1);
+        CHECK(statistics.clips.at(clip.get()).curves_evaluated == 1);
+    }
+
+    animator_system.update(registry, 0.1f);
+    {
+        const auto &statistics = animator_system.statistics();
+        CHECK(statistics.hint_hits == 1);
+        CHECK(statistics.upper_bound_fallbacks == 0);
+    }
+
+    registry.emplace_component<AnimatorStop>(entity);
+    animator_system.update(registry, 0.1f);
+    CHECK(animator_system.statistics().clips.at(clip.get()).bound_entities == 0);
+
+    // The entries of clips no longer evaluated are dropped.
+    animator_system.update(registry, 0.1f);
+    CHECK(animator_system.statistics().clips.empty());
+}
+
+TEST_CASE("Testing statistics of lazy evaluation") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    AnimatorSystem animator_system(component_registry);
+
+    auto clip = std::make_shared<resources::AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({10.f, 10.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<LazyEvaluation>(entity);
+    registry.emplace_component<Animator>(entity).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    for (int i = 0; i < 3; ++i) {
+        animator_system.update(registry, 1.f);
+    }
+    animator_system.evaluate(registry, entity);
+    animator_system.evaluate(registry, entity);
+
+    const auto &statistics = animator_system.statistics();
+    CHECK(statistics.lazy_entities_skipped == 1);
+    CHECK(statistics.lazy_evaluations == 1);
+    CHECK(statistics.curves_evaluated == 0);
+}
@@ -0,0 +1,129 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <cstdio>
+
+#include <nodec_animation/serialization/streaming_clip.hpp>
+
+struct ComponentA {
+    float prop;
+};
+struct ComponentB {
+    float prop;
+};
+
+TEST_CASE("Testing streaming clips") {
+    using namespace nodec_animation;
+    using namespace nodec_animation::resources;
+    using namespace nodec_animation::serialization;
+
+    // Ten minutes at irregular key times, so that keys fall on and between the chunk boundaries.
+    AnimationClip clip;
+    AnimationCurve curve_a;
+    AnimationCurve curve_b;
+    for (int i = 0; i <= 6000; ++i) {
+        curve_a.add_keyframe({i * 0.1f, static_cast<float>(i % 17)});
+    }
+    for (int i = 0; i <= 400; ++i) {
+        curve_b.add_keyframe({i * 1.5f, static_cast<float>(i * i)});
+    }
+    clip.set_curve<ComponentA>("", "prop", curve_a);
+    clip.set_curve<ComponentB>("child/grandchild", "prop", curve_b);
+    clip.set_curve<ComponentB>("child", "empty", AnimationCurve());
+    clip.add_event({42.f, 1, 2, 3.f});
+
+    BinaryClipTypeTable types;
+    types.register_type<ComponentA>("ComponentA");
+    types.register_type<ComponentB>("ComponentB");
+
+    const char *path = "nodec_animation__streaming_clip.nacs";
+    CHECK(!write_streaming_clip(clip, types, 0.f, path));
+    REQUIRE(write_streaming_clip(clip, types, 2.f, path));
+
+    auto streamed = open_streaming_clip(path, types);
+    REQUIRE(streamed);
+    CHECK(streamed->duration() == clip.duration());
+    REQUIRE(streamed->events().size() == 1);
+    CHECK(streamed->events()[0].id == 1);
+
+    auto *stream = dynamic_cast<StreamingClip *>(streamed->stream());
+    REQUIRE(stream);
+    CHECK(stream->chunk_count() == 300);
+    CHECK(stream->resident_chunk() == -1);
+
+    auto *streamed_a = streamed->find_curve("", nodec::type_id<ComponentA>(), "prop");
+    auto *streamed_b = streamed->find_curve("child/grandchild", nodec::type_id<ComponentB>(), "prop");
+    auto *streamed_empty = streamed->find_curve("child", nodec::type_id<ComponentB>(), "empty");
+    REQUIRE(streamed_a);
+    REQUIRE(streamed_b);
+    REQUIRE(streamed_empty);
+
+    SUBCASE("playback evaluates like the whole curves") {
+        int hint_a = -1;
+        int hint_b = -1;
+        std::size_t max_resident = 0;
+
+        for (float time = 0.f; time <= clip.duration() + 1.f; time += 1.f / 60) {
+            stream->prepare(time);
+            // Stands in for the time a frame takes.
+            stream->wait_for_prefetch();
+
+            const auto a = streamed_a->evaluate(time, hint_a);
+            const auto b = streamed_b->evaluate(time, hint_b);
+            hint_a = a.first;
+            hint_b = b.first;
+
+            CHECK(a.second == curve_a.evaluate(time).second);
+            CHECK(b.second == curve_b.evaluate(time).second);
+            CHECK(streamed_empty->keyframes().empty());
+
+            if (stream->resident_chunk() % 50 == 0) {
+                const auto resident = stream->resident_keyframe_count();
+                max_resident = resident < max_resident ? max_resident : resident;
+            }
+        }
+
+        // Two chunks of about 20 + 2 keys of curve A and 2 + 2 keys of curve B.
+        CHECK(max_resident <= 2 * (23 + 4));
+        CHECK(stream->synchronous_reads() == 1);
+        CHECK(stream->prefetch_hits() == 299);
+    }
+
+    SUBCASE("seeking reads the chunk synchronously") {
+        stream->prepare(400.f);
+        CHECK(stream->resident_chunk() == 200);
+        CHECK(streamed_a->evaluate(400.05f).second == curve_a.evaluate(400.05f).second);
+
+        stream->prepare(3.f);
+        CHECK(stream->resident_chunk() == 1);
+        CHECK(streamed_b->evaluate(3.7f).second == curve_b.evaluate(3.7f).second);
+
+        stream->prepare(-1.f);
+        CHECK(stream->resident_chunk() == 0);
+    }
+
+    SUBCASE("reverse playback reads ahead backwards") {
+        for (float time = 100.f; time >= 50.f; time -= 1.f / 30) {
+            stream->prepare(time);
+            stream->wait_for_prefetch();
+            CHECK(streamed_a->evaluate(time).second == curve_a.evaluate(time).second);
+        }
+        // The first chunk and the one after turning around are read synchronously.
+        CHECK(stream->synchronous_reads() == 2);
+        CHECK(stream->prefetch_hits() == 24);
+    }
+
+    streamed.reset();
+    std::remove(path);
+
+    SUBCASE("invalid files") {
+        CHECK(!open_streaming_clip(path, types));
+
+        AnimationClip looping;
+        AnimationCurve curve;
+        curve.add_keyframe({1.f, 1.f});
+        curve.set_wrap_mode(WrapMode::Loop);
+        looping.set_curve<ComponentA>("", "prop", curve);
+        CHECK(!write_streaming_clip(looping, types, 1.f, path));
+    }
+}
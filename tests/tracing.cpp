@@ -0,0 +1,112 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <nodec_animation/systems/animator_system.hpp>
+#include <nodec_animation/tracing.hpp>
+#include <nodec_scene/scene.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct TestComponent {
+    float value{0.f};
+
+    template<class Archive>
+    void serialize(Archive &archive) {
+        archive(cereal::make_nvp("value", value));
+    }
+};
+
+TEST_CASE("Testing RingBufferTracer") {
+    using namespace nodec_animation;
+
+    SUBCASE("capacity is rounded up and the oldest events are overwritten") {
+        RingBufferTracer tracer(3);
+        CHECK(tracer.capacity() == 4);
+
+        for (int i = 0; i < 3; ++i) {
+            ScopedTraceZone zone(&tracer, "zone");
+        }
+        CHECK(tracer.recorded_count() == 6);
+
+        int count = 0;
+        tracer.each([&](const RingBufferTracer::Event &) { ++count; });
+        CHECK(count == 4);
+
+        tracer.clear();
+        CHECK(tracer.recorded_count() == 0);
+    }
+
+    SUBCASE("null tracer") {
+        ScopedTraceZone zone(nullptr, "zone");
+    }
+}
+
+TEST_CASE("Testing trace zones of AnimatorSystem") {
+    using namespace nodec_scene;
+    using namespace nodec_animation;
+    using namespace nodec_animation::components;
+    using namespace nodec_animation::systems;
+
+    ComponentRegistry component_registry;
+    component_registry.register_component<TestComponent>();
+
+    RingBufferTracer tracer;
+    AnimatorSystem animator_system(component_registry);
+    animator_system.set_tracer(&tracer);
+
+    auto clip = std::make_shared<resources::AnimationClip>();
+    {
+        AnimationCurve curve;
+        curve.add_keyframe({0.f, 0.f});
+        curve.add_keyframe({1.f, 1.f});
+        clip->set_curve<TestComponent>("", "value", curve);
+    }
+
+    Scene scene;
+    auto &registry = scene.registry();
+
+    auto entity = scene.create_entity("root");
+    registry.emplace_component<TestComponent>(entity);
+    registry.emplace_component<Animator>(entity).first.clip = clip;
+    registry.emplace_component<AnimatorStart>(entity);
+
+    animator_system.update(registry, 0.1f);
+
+    std::vector<std::string> stack;
+    bool balanced = true;
+    bool has_update = false;
+    bool has_bind = false;
+    bool has_component = false;
+
+    tracer.each([&](const RingBufferTracer::Event &event) {
+        const std::string name = event.name;
+        if (event.phase == 'B') {
+            stack.push_back(name);
+            has_update |= name == "AnimatorSystem::update";
+            has_bind |= name == "bind";
+            has_component |= name == typeid(TestComponent).name();
+        } else {
+            balanced &= !stack.empty() && stack.back() == name;
+            if (!stack.empty()) stack.pop_back();
+        }
+    });
+
+    CHECK(balanced);
+    CHECK(stack.empty());
+    CHECK(has_update);
+    CHECK(has_bind);
+    CHECK(has_component);
+
+    std::ostringstream out;
+    tracer.write_chrome_trace(out);
+    const auto json = out.str();
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"AnimatorSystem::update\"") != std::string::npos);
+
+    animator_system.set_tracer(nullptr);
+    const auto recorded = tracer.recorded_count();
+    animator_system.update(registry, 0.1f);
+    CHECK(tracer.recorded_count() == recorded);
+}